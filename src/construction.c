@@ -31,20 +31,41 @@
 #include "generation.h"
 #include "construction.h"
 #include "atomic.h"
+#include "sort_adjacency.h"
+#include "snapshot.h"
 
-static I64_t *count_edgelist_size(struct edgelist_t *list);
-static struct graph_t *allocate_graph(struct edgelist_t *list, I64_t num_nodes, I64_t *num_edges);
-static I64_t count_node_degree(struct graph_t *G, struct edgelist_t *list);
-static int parallel_prefix_sum(struct graph_t *G);
-static void construct_subgraphs(struct graph_t *G, struct edgelist_t *list);
+static struct edge_partition_t *count_partitioned_edges(struct edgelist_t *list, I64_t *num_edges);
+static void partition_edges(struct graph_t *G, struct edgelist_t *list, struct edge_partition_t *P);
+static void construct_subgraphs(struct graph_t *G, struct edge_partition_t *P);
 static void extract_duplicated_edges(struct graph_t *G);
+static inline int ilog2(unsigned long long x);
+
+/* edges of a sub-graph grouped by destination block. an edge is packed as
+   (the vertex offset in the block << log_n) | (the adjacent vertex). */
+struct edge_partition_t {
+  struct mempool_t pool;
+  I64_t *edges;
+  I64_t log_n;      /* #bits of a vertex */
+  I64_t log_blk;    /* #bits of a block */
+  I64_t nblocks;
+  I64_t *offset;    /* [#threads][nblocks] : write offset of each thread */
+  I64_t *base;      /* [nblocks+1] : first edge of each block */
+};
 
 
 struct graph_t *graph_construction(struct edgelist_t *list) {
   struct graph_t *G = NULL;
 
-  I64_t *num_edges = count_edgelist_size(list);
-  assert( G = allocate_graph(list, list->num_nodes, num_edges) );
+  const char *snapshot = getenv(ENV_SNAPSHOT);
+  if ( snapshot && (G = restore_graph_snapshot(snapshot, list)) ) {
+    return G;
+  }
+
+  struct edge_partition_t *P = NULL;
+  I64_t *num_edges = NULL;
+  assert( num_edges = (I64_t *)calloc(list->num_lists, sizeof(I64_t)) );
+  P = count_partitioned_edges(list, num_edges);
+  assert( G = allocate_graph_numa(list->num_nodes, list->num_lists, num_edges) );
   free(num_edges);
 
   printf("G = {\n");
@@ -60,11 +81,9 @@ struct graph_t *graph_construction(struct edgelist_t *list) {
 
   printf("graph construction without self-loop and duplicated-edges ... \n");
   const double s_time = get_seconds();
-  count_node_degree(G, list);
-  printf("[elapsed: %6.2fs] finished: count each vertex degree\n", get_seconds()-s_time);
-  parallel_prefix_sum(G);
-  printf("[elapsed: %6.2fs] finished: parallel prefix sum\n", get_seconds()-s_time);
-  construct_subgraphs(G, list);
+  partition_edges(G, list, P);
+  printf("[elapsed: %6.2fs] finished: partition edges by destination block\n", get_seconds()-s_time);
+  construct_subgraphs(G, P);
   printf("[elapsed: %6.2fs] finished: construct sub-graphs\n", get_seconds()-s_time);
   extract_duplicated_edges(G);
   printf("[elapsed: %6.2fs] finished: extracting duplicated edges\n", get_seconds()-s_time);
@@ -81,6 +100,9 @@ struct graph_t *graph_construction(struct edgelist_t *list) {
   }
   printf("} = (N= %lld nodes, M= %lld edges)\n", G->n, G->m);
 
+  if (snapshot) {
+    save_snapshot(snapshot, G, list);
+  }
   return G;
 }
 
@@ -88,15 +110,53 @@ struct graph_t *graph_construction(struct edgelist_t *list) {
 
 
 /* ------------------------------------------------------------
- * count_edgelist_size
+ * load_edges
+ *   edges [pos, pos+n) of the node local edgelist k: the stored
+ *   edges, or the edges of a regenerated edgelist written into buf
+ *   (n <= REGENERATE_CHUNK_EDGES).
+ * ------------------------------------------------------------ */
+static inline const struct packed_edge *load_edges(const struct edgelist_t *list, int k,
+                                                   I64_t pos, I64_t n, struct packed_edge *buf) {
+  const struct IJ_list_t *IJ_list = &list->IJ_list[k];
+  if (!list->regenerate) return &IJ_list->edges[pos];
+  regenerate_edges(list, IJ_list->offset + pos, IJ_list->offset + pos + n, buf);
+  return buf;
+}
+
+
+
+
+/* ------------------------------------------------------------
+ * count_partitioned_edges
+ *   the vertices of a sub-graph are split into power-of-two blocks,
+ *   at most one per core of its node. each thread reads only its
+ *   part of the node local edgelist, once, and counts both
+ *   directions of each edge for the block of the owner node into
+ *   its own row; the rows are then laid out block-major and
+ *   thread-minor, which gives every thread a private range of each
+ *   block of every owner (no atomics). a regenerated edgelist is
+ *   regenerated in chunks here and once more by partition_edges.
  * ------------------------------------------------------------ */
-static I64_t *count_edgelist_size(struct edgelist_t *list) {
-  I64_t *ne = NULL;
-  I64_t chunk = ROUNDUP(list->num_nodes/list->num_lists, 64);
-  I64_t log_c = log2(chunk);
+static struct edge_partition_t *count_partitioned_edges(struct edgelist_t *list, I64_t *num_edges) {
+  struct edge_partition_t *P = NULL;
+  const I64_t chunk = ROUNDUP(list->num_nodes/list->num_lists, 64);
+  const I64_t log_c = log2(chunk);
+  const int nthreads = get_numa_num_threads();
   I64_t self_loops = 0;
+  assert( P = (struct edge_partition_t *)calloc(list->num_lists, sizeof(struct edge_partition_t)) );
 
-  assert( ne = (I64_t *)calloc(list->num_lists, sizeof(I64_t)) );
+  int k;
+  for (k = 0; k < list->num_lists; ++k) {
+    const I64_t vs = chunk * k;
+    const I64_t n = ((k+1 < list->num_lists) ? chunk * (k+1) : list->num_nodes) - vs;
+    const I64_t lcores = get_numa_online_cores(k);
+    P[k].log_n   = ilog2(list->num_nodes);
+    P[k].log_blk = ilog2( (n > lcores) ? (n + lcores-1) / lcores : 1 );
+    P[k].nblocks = (n + (1LL << P[k].log_blk) - 1) >> P[k].log_blk;
+    assert( P[k].log_n + P[k].log_blk < 64 );
+    assert( P[k].offset = (I64_t *)calloc(nthreads * P[k].nblocks, sizeof(I64_t)) );
+    assert( P[k].base   = (I64_t *)calloc(P[k].nblocks + 1,        sizeof(I64_t)) );
+  }
 
   OMP("omp parallel num_threads(get_numa_num_threads()) reduction(+:self_loops)") {
     int id = omp_get_thread_num();
@@ -106,47 +166,66 @@ static I64_t *count_edgelist_size(struct edgelist_t *list) {
     pinned(USE_HYBRID_AFFINITY, id);
     OMP("omp barrier");
 
-    I64_t j, ls, le;
-    I64_t *fm = (I64_t *)CALLOCA(list->num_lists * sizeof(I64_t));
-    struct IJ_list_t *IJ_list = &list->IJ_list[nodeid];
-    struct packed_edge *IJ = IJ_list->edges;
-    partial_range(IJ_list->length, 0, lcores, coreid, &ls, &le);
-    for (j = ls; j < le; ++j) {
-      const I64_t v = get_v0_from_edge(&IJ[j]);
-      const I64_t w = get_v1_from_edge(&IJ[j]);
-      if (v != w) {
-        ++fm[w >> log_c];
-        ++fm[v >> log_c];
-      } else {
-        ++self_loops;
+    I64_t j, ls, le, pos, b, t;
+    struct packed_edge *buf = NULL;
+    if (list->regenerate) {
+      assert( buf = (struct packed_edge *)malloc(REGENERATE_CHUNK_EDGES * sizeof(struct packed_edge)) );
+    }
+    partial_range(list->IJ_list[nodeid].length, 0, lcores, coreid, &ls, &le);
+    for (pos = ls; pos < le; pos += REGENERATE_CHUNK_EDGES) {
+      const I64_t n = (le - pos < (I64_t)REGENERATE_CHUNK_EDGES) ? le - pos : (I64_t)REGENERATE_CHUNK_EDGES;
+      const struct packed_edge *IJ = load_edges(list, nodeid, pos, n, buf);
+      for (j = 0; j < n; ++j) {
+        const I64_t v = get_v0_from_edge(&IJ[j]);
+        const I64_t w = get_v1_from_edge(&IJ[j]);
+        if (v == w) {
+          ++self_loops;
+          continue;
+        }
+        const struct edge_partition_t *PW = &P[w >> log_c];
+        const struct edge_partition_t *PV = &P[v >> log_c];
+        ++PW->offset[id * PW->nblocks + ((w & (chunk-1)) >> PW->log_blk)];
+        ++PV->offset[id * PV->nblocks + ((v & (chunk-1)) >> PV->log_blk)];
       }
     }
+    free(buf);
+    OMP("omp barrier");
 
-    int k;
-    for (k = 0; k < list->num_lists; ++k) {
-      SYNC_FETCH_AND_ADD(&ne[k], fm[k]);
+    /* counts to write offsets of the owner: block-major, thread-minor */
+    if (coreid == 0) {
+      struct edge_partition_t *PT = &P[nodeid];
+      I64_t sum = 0;
+      for (b = 0; b < PT->nblocks; ++b) {
+        PT->base[b] = sum;
+        for (t = 0; t < nthreads; ++t) {
+          const I64_t c = PT->offset[t * PT->nblocks + b];
+          PT->offset[t * PT->nblocks + b] = sum;
+          sum += c;
+        }
+      }
+      PT->base[PT->nblocks] = sum;
+      num_edges[nodeid] = sum;
     }
-
     clear_affinity();
   }
   printf("# of self-loops is %lld\n", self_loops);
 
-  return ne;
+  return P;
 }
 
 
 
 
 /* ------------------------------------------------------------
- * allocate_graph
+ * allocate_graph_numa
  * ------------------------------------------------------------ */
-static struct graph_t *allocate_graph(struct edgelist_t *list, I64_t num_nodes, I64_t *num_edges) {
+struct graph_t *allocate_graph_numa(I64_t num_nodes, int num_graphs, const I64_t *num_edges) {
   int k;
   const size_t spacing = 64;
-  I64_t *offset = (I64_t *)CALLOCA((list->num_lists+1) * sizeof(I64_t));
-  I64_t chunk = ROUNDUP(list->num_nodes/list->num_lists, 64);
+  I64_t *offset = (I64_t *)CALLOCA((num_graphs+1) * sizeof(I64_t));
+  I64_t chunk = ROUNDUP(num_nodes/num_graphs, 64);
   I64_t sum_of_num_edges = 0;
-  for (k = 0; k < list->num_lists; ++k) {
+  for (k = 0; k < num_graphs; ++k) {
     offset[k] = chunk * k;
     sum_of_num_edges += num_edges[k];
   }
@@ -157,7 +236,7 @@ static struct graph_t *allocate_graph(struct edgelist_t *list, I64_t num_nodes,
   G->n = num_nodes;
   G->m = sum_of_num_edges;
   G->chunk = chunk;
-  G->num_graphs = list->num_lists;
+  G->num_graphs = num_graphs;
   assert( G->BG_list  = (struct subgraph_t *)calloc(G->num_graphs+1, sizeof(struct subgraph_t)) );
   assert( G->pool     = (struct mempool_t  *)calloc(G->num_graphs+1, sizeof(struct mempool_t )) );
 
@@ -202,10 +281,25 @@ static struct graph_t *allocate_graph(struct edgelist_t *list, I64_t num_nodes,
 
 
 /* ------------------------------------------------------------
- * construct_subgraphs
+ * partition_edges
+ *   the exchange: each thread reads its part of the node local
+ *   edgelist once more and pushes each direction of an edge into
+ *   its private range of the owner's block, in the staging area on
+ *   the owner node. an owner then builds its sub-graph from node
+ *   local data only. a regenerated edgelist is not kept in DRAM,
+ *   so its edges are staged in end[] itself and sorted in place.
  * ------------------------------------------------------------ */
-static I64_t count_node_degree(struct graph_t *G, struct edgelist_t *list) {
-  I64_t fixed = 0;
+static void partition_edges(struct graph_t *G, struct edgelist_t *list, struct edge_partition_t *P) {
+  int k;
+  for (k = 0; k < G->num_graphs; ++k) {
+    if (list->regenerate) {
+      P[k].edges = G->BG_list[k].end;
+    } else {
+      P[k].pool  = lmalloc(ROUNDUP( (G->BG_list[k].m+1) * sizeof(I64_t), hugepage_size() ), k);
+      P[k].edges = (I64_t *)P[k].pool.pool;
+    }
+    assert( P[k].base[P[k].nblocks] == G->BG_list[k].m );
+  }
 
   OMP("omp parallel num_threads(get_numa_num_threads())") {
     int id = omp_get_thread_num();
@@ -215,51 +309,53 @@ static I64_t count_node_degree(struct graph_t *G, struct edgelist_t *list) {
     pinned(USE_HYBRID_AFFINITY, id);
     OMP("omp barrier");
 
-    struct subgraph_t *BG = &G->BG_list[nodeid];
-    I64_t ls, le, j;
-    partial_range(BG->n+1, 0, lcores, coreid, &ls, &le);
-    for (j = ls; j < le; ++j) {
-      BG->start[j] = 0;
+    const I64_t chunk = G->chunk;
+    const I64_t log_c = log2(chunk);
+    I64_t j, ls, le, pos;
+    struct packed_edge *buf = NULL;
+    if (list->regenerate) {
+      assert( buf = (struct packed_edge *)malloc(REGENERATE_CHUNK_EDGES * sizeof(struct packed_edge)) );
     }
-    OMP("omp barrier");
-
-    int k;
-    for (k = 0; k < list->num_lists; ++k) {
-      int target = (nodeid+k+1) % G->num_graphs;
-
-      const I64_t log_c = log2(G->chunk);
-      struct packed_edge *E = list->IJ_list[target].edges;
-      I64_t lls, lle;
-      I64_t BG_offset = BG->offset;
-      I64_t *BG_start = BG->start;
-      partial_range(list->IJ_list[target].length, 0, lcores, coreid, &lls, &lle);
-      for (j = lls; j < lle; ++j) {
-        const I64_t v = get_v0_from_edge(&E[j]);
-        const I64_t w = get_v1_from_edge(&E[j]);
-        if (v != w && (w >> log_c) == nodeid) {
-          SYNC_FETCH_AND_ADD(&BG_start[w+1 - BG_offset], 1); /* v <- w */
+    partial_range(list->IJ_list[nodeid].length, 0, lcores, coreid, &ls, &le);
+    for (pos = ls; pos < le; pos += REGENERATE_CHUNK_EDGES) {
+      const I64_t n = (le - pos < (I64_t)REGENERATE_CHUNK_EDGES) ? le - pos : (I64_t)REGENERATE_CHUNK_EDGES;
+      const struct packed_edge *IJ = load_edges(list, nodeid, pos, n, buf);
+      for (j = 0; j < n; ++j) {
+        const I64_t v = get_v0_from_edge(&IJ[j]);
+        const I64_t w = get_v1_from_edge(&IJ[j]);
+        if (v == w) continue;
+        { /* v <- w */
+          struct edge_partition_t *PT = &P[w >> log_c];
+          const I64_t x = w & (chunk-1);
+          PT->edges[ PT->offset[id * PT->nblocks + (x >> PT->log_blk)]++ ]
+            = ((x & ((1LL << PT->log_blk) - 1)) << PT->log_n) | v;
         }
-        if (v != w && (v >> log_c) == nodeid) {
-          SYNC_FETCH_AND_ADD(&BG_start[v+1 - BG_offset], 1); /* w <- v */
+        { /* w <- v */
+          struct edge_partition_t *PT = &P[v >> log_c];
+          const I64_t x = v & (chunk-1);
+          PT->edges[ PT->offset[id * PT->nblocks + (x >> PT->log_blk)]++ ]
+            = ((x & ((1LL << PT->log_blk) - 1)) << PT->log_n) | w;
         }
       }
     }
+    free(buf);
     OMP("omp barrier");
+    clear_affinity();
   }
-
-  return fixed;
 }
 
 
 
 
 /* ------------------------------------------------------------
- * parallel_prefix_sum
+ * construct_subgraphs
+ *   each block is counted and scattered into start[]/end[] by a
+ *   single owner thread (counting sort within the block). edges
+ *   staged in end[] itself are sorted in place instead: cycle
+ *   leader with the cursors of the block in a per-thread scratch,
+ *   then the packed vertex offsets are masked off.
  * ------------------------------------------------------------ */
-static int parallel_prefix_sum(struct graph_t *G) {
-  I64_t BG_ps_off[MAX_NODES][MAX_CPUS+1] = {{0}};
-
-
+static void construct_subgraphs(struct graph_t *G, struct edge_partition_t *P) {
   OMP("omp parallel num_threads(get_numa_num_threads())") {
     int id = omp_get_thread_num();
     int nodeid = get_numa_nodeid(id);
@@ -268,94 +364,84 @@ static int parallel_prefix_sum(struct graph_t *G) {
     pinned(USE_HYBRID_AFFINITY, id);
     OMP("omp barrier");
 
-    /* constuct start[] */
     struct subgraph_t *BG = &G->BG_list[nodeid];
-    I64_t j, ls, le;
-    /* parallel prefix-sum */
-    partial_range(BG->n+1, 0, lcores, coreid, &ls, &le);
-    for (j = ls+1; j < le; ++j) {
-      BG->start[j] += BG->start[j-1];
+    const struct edge_partition_t *PT = &P[nodeid];
+    const I64_t log_n = PT->log_n;
+    const I64_t v_mask = (1LL << log_n) - 1;
+    const I64_t *edges = PT->edges;
+    const int in_place = (PT->edges == BG->end);
+    I64_t *start = BG->start;
+    I64_t *next = NULL;
+    I64_t b, j, v;
+    if (in_place) {
+      assert( next = (I64_t *)malloc((1LL << PT->log_blk) * sizeof(I64_t)) );
     }
-    BG_ps_off[nodeid][coreid+1] = BG->start[le-1];
-    OMP("omp barrier");
 
-    if (coreid == 0) {
-      I64_t p;
-      for (p = 1; p <= lcores; ++p) {
-        BG_ps_off[nodeid][p] += BG_ps_off[nodeid][p-1];
-      }
-    }
-    OMP("omp barrier");
+    for (b = coreid; b < PT->nblocks; b += lcores) {
+      const I64_t vs = b << PT->log_blk;
+      const I64_t ve = (vs + (1LL << PT->log_blk) < BG->n) ? vs + (1LL << PT->log_blk) : BG->n;
+      const I64_t es = PT->base[b], ee = PT->base[b+1];
 
-    const I64_t BG_ps_off_local = BG_ps_off[nodeid][coreid];
-    if ( BG_ps_off_local ) {
-      partial_range(BG->n+1, 0, lcores, coreid, &ls, &le);
-      for (j = ls; j < le; ++j) {
-        BG->start[j] += BG_ps_off_local;
+      /* degree and first edge of each vertex */
+      for (v = vs; v < ve; ++v) {
+        start[v] = 0;
+      }
+      for (j = es; j < ee; ++j) {
+        ++start[ vs + (edges[j] >> log_n) ];
+      }
+      I64_t sum = es;
+      for (v = vs; v < ve; ++v) {
+        const I64_t dg = start[v];
+        start[v] = sum;
+        sum += dg;
       }
-    }
-    OMP("omp barrier");
-
-    if ( BG->start[BG->n] != BG->m ) {
-      printf("BG->n is %lld(%lld)\n", BG->m, BG->start[BG->n]);
-    }
-    assert( BG->start[BG->n] == BG->m );
-  }
-  return 0;
-}
-
-
-
-
-/* ------------------------------------------------------------
- * construct_subgraphs
- * ------------------------------------------------------------ */
-static void construct_subgraphs(struct graph_t *G, struct edgelist_t *list) {
-  OMP("omp parallel num_threads(get_numa_num_threads())") {
-    int id = omp_get_thread_num();
-    int nodeid = get_numa_nodeid(id);
-    int coreid = get_numa_vircoreid(id);
-    int lcores = get_numa_online_cores(nodeid);
-    pinned(USE_HYBRID_AFFINITY, id);
-    OMP("omp barrier");
 
-    /* constuct start[] */
-    struct subgraph_t *BG = &G->BG_list[nodeid];
-    int k;
-    I64_t j;
-    /* construct adjacency_list */
-    for (k = 0; k < list->num_lists; ++k) {
-      int target = (nodeid+k+1) % G->num_graphs;
-
-      const I64_t log_c = log2(G->chunk);
-      struct packed_edge *E = list->IJ_list[target].edges;
-      I64_t lls, lle;
-      partial_range(list->IJ_list[target].length, 0, lcores, coreid, &lls, &lle);
-
-      for (j = lls; j < lle; ++j) {
-        const I64_t v = get_v0_from_edge(&E[j]);
-        const I64_t w = get_v1_from_edge(&E[j]);
-        if (v != w) {
-          if ((w>>log_c) == nodeid) {
-            BG->end[ SYNC_FETCH_AND_ADD(&BG->start[w - BG->offset], 1) ] = v;
-          }
-          if ((v>>log_c) == nodeid) {
-            BG->end[ SYNC_FETCH_AND_ADD(&BG->start[v - BG->offset], 1) ] = w;
+      if (in_place) {
+        I64_t *end = BG->end;
+        for (v = vs; v < ve; ++v) {
+          next[v-vs] = start[v];
+        }
+        for (v = vs; v < ve; ++v) {
+          const I64_t x = v - vs, lim = (v+1 < ve) ? start[v+1] : ee;
+          while (next[x] < lim) {
+            I64_t e = end[ next[x] ], y = e >> log_n;
+            while (y != x) {
+              const I64_t t = end[ next[y] ];
+              end[ next[y]++ ] = e;
+              e = t, y = e >> log_n;
+            }
+            end[ next[x]++ ] = e;
           }
         }
+        for (j = es; j < ee; ++j) {
+          end[j] &= v_mask;
+        }
+        continue;
       }
-    }
-    OMP("omp barrier");
 
-    if (coreid == 0) {
-      for (j = BG->n; j > 0; --j) {
-        BG->start[j] = BG->start[j-1];
+      /* scatter (start[v] moves to the end of v), then restore start[] */
+      for (j = es; j < ee; ++j) {
+        BG->end[ start[ vs + (edges[j] >> log_n) ]++ ] = edges[j] & v_mask;
+      }
+      for (v = ve-1; v > vs; --v) {
+        start[v] = start[v-1];
       }
-      BG->start[0] = 0;
+      start[vs] = es;
     }
+    if (coreid == 0) {
+      start[BG->n] = BG->m;
+    }
+    free(next);
     OMP("omp barrier");
     clear_affinity();
   }
+
+  for (int k = 0; k < G->num_graphs; ++k) {
+    if (P[k].pool.pool) lfree(P[k].pool);
+    free(P[k].offset);
+    free(P[k].base);
+  }
+  free(P);
 }
 
 
@@ -414,56 +500,10 @@ static void update_degree_table(struct graph_t *G) {
   assert( degree_sum == G->m );
 }
 
-static int intdegreecmp(const void *a, const void *b) {
-  const I64_t _a = *(const I64_t *)a;
-  const I64_t _b = *(const I64_t *)b;
-  const I64_t _ia = degree_table[_a];
-  const I64_t _ib = degree_table[_b];
-#if 1
-  /* descending order */
-  /* Intel(R) Xeon(R) CPU E5-4640 2.40GHz */
-  /*    Kronecker SCALE=26, edgefactor=16 */
-  if (_ia > _ib) return -1;
-  if (_ia < _ib) return  1;
-  if ( _a >  _b) return -1;
-  if ( _a <  _b) return  1;
-#else
-  /* ascending order */
-  /* Intel(R) Xeon(R) CPU E5-4640 2.40GHz */
-  /*    Kronecker SCALE=26, edgefactor=16 */
-  if (_ia < _ib) return -1;
-  if (_ia > _ib) return  1;
-  if ( _a <  _b) return -1;
-  if ( _a >  _b) return  1;
-#endif
-  return 0;
-}
-
 static void sort_adjacency_list_by_degree(struct graph_t *G) {
-  I64_t duplicates = 0;
   const double t1 = get_seconds();
-  OMP("omp parallel num_threads(get_numa_num_threads()) reduction(+:duplicates)") {
-    int id = omp_get_thread_num();
-    int nodeid = get_numa_nodeid(id);
-    int coreid = get_numa_vircoreid(id);
-    int lcores = get_numa_online_cores(nodeid);
-    pinned(USE_HYBRID_AFFINITY, id);
-    I64_t ls, le;
-    struct subgraph_t *BG = &G->BG_list[nodeid];
-    partial_range(BG->n, 0, lcores, coreid, &ls, &le);
-    for (I64_t j = ls; j < le; ++j) {
-      I64_t bs = BG->start[j], be = BG->start[j+1], dg = be-bs;
-      if (dg) {
-        I64_t *array = &BG->end[bs];
-        I64_t uniq_dg = uniq(array, dg, sizeof(I64_t), qsort, intdegreecmp);
-        for (I64_t i = uniq_dg; i < dg; ++i) array[i] = -1; /* filled -1 */
-        duplicates += dg - uniq_dg;
-      }
-    }
-
-    OMP("omp barrier");
-    clear_affinity();
-  }
+  const I64_t duplicates = sort_adjacency_lists_by_degree(G->BG_list, G->num_graphs, 1,
+                                                          G->n, degree_table, NULL);
   const double t2 = get_seconds();
 
   printf("found %lld duplicated edges (%.3f %%) (%.3f seconds)\n",
@@ -479,40 +519,12 @@ static void extract_duplicated_edges(struct graph_t *G) {
   sort_adjacency_list_by_degree(G);
 
   const double t1 = get_seconds();
-  OMP("omp parallel num_threads(get_numa_num_threads())") {
-    int id = omp_get_thread_num();
-    int nodeid = get_numa_nodeid(id);
-    int coreid = get_numa_vircoreid(id);
-    pinned(USE_HYBRID_AFFINITY, id);
-    if (coreid == 0) {
-      I64_t crr;
-      /* Backward Graph */
-      crr = 0;
-      struct subgraph_t *BG = &G->BG_list[nodeid];
-      for (I64_t j = 0; j < BG->n; ++j) {
-        const I64_t ls = BG->start[j], le = BG->start[j+1];
-        BG->start[j] = crr;
-        for (I64_t w = ls; w < le; ++w) {
-          I64_t v = BG->end[w];
-          if (v != -1) {
-            BG->end[crr++] = v;
-          }
-        }
-      }
-      BG->start[BG->n] = crr;
-      BG->m = crr;
-    }
-  }
-
-  /* update # of edges */
-  G->m = 0;
-  for (int k = 0; k < G->num_graphs; ++k) {
-    G->m += G->BG_list[k].m;
-  }
+  /* Backward Graph, and update # of edges */
+  G->m = compact_adjacency_lists(G->BG_list, G->num_graphs, 1, 0);
   update_degree_table(G);
 
   const double t2 = get_seconds();
-  printf("extract duplicated edges (#threads=1, %.3f seconds)\n", t2-t1);
+  printf("extract duplicated edges (#threads=%d, %.3f seconds)\n", get_numa_num_threads(), t2-t1);
 
   /* dump degree */
   dump_degree_distribution(G);
@@ -633,6 +645,7 @@ void free_graph(struct graph_t *G) {
   for (k = 0; k < G->num_graphs; ++k) {
     lfree(G->pool[k]);
   }
+  detach_snapshot(&G->shared);
   free(G->BG_list);
   free(G->pool);
   free(G);
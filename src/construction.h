@@ -26,6 +26,8 @@
 #include "defs.h"
 #include "atomic.h"
 
+struct edgelist_t;
+
 struct subgraph_t {
   I64_t n;
   I64_t m;
@@ -42,9 +44,11 @@ struct graph_t {
   struct subgraph_t *FG_list;
   struct subgraph_t *BG_list;
   struct mempool_t *pool;
+  struct mempool_t shared;  /* attached read-only snapshot, if any */
 };
 
 extern struct graph_t *graph_construction(struct edgelist_t *list);
+extern struct graph_t *allocate_graph_numa(I64_t num_nodes, int num_graphs, const I64_t *num_edges);
 extern int dump_graph(const char *filename, struct graph_t *G);
 extern void free_graph(struct graph_t *G);
 
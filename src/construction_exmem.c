@@ -41,6 +41,7 @@
 #include "generation.h"
 #include "construction.h"
 #include "atomic.h"
+#include "sort_adjacency.h"
 
 #include "dump.h"
 //#include "external_full_construction.h"
@@ -73,12 +74,17 @@ struct graph_t *graph_construction(struct edgelist_t *list) {
   t2 = get_seconds();
   printf ("external full graph construction takes %.3lf seconds", t2-t1);
 
+#if COMPRESS_GRAPH_END == 1
+  printf ("\n[ compress end files ]\n");
+  compress_graph_end(1);
+#endif
+
   struct dumpfiles_t *DF_G_s = NULL;
   struct dumpfiles_t *DF_G_e = NULL;
   DF_G_s = init_dumpfile_info_graph("", 1, 0);
   DF_G_e = init_dumpfile_info_graph("", 0, 0);
-  fopen_files_readmode(DF_G_s);
-  fopen_files_readmode(DF_G_e);
+  open_files_readmode(DF_G_s);
+  open_files_readmode(DF_G_e);
 
 
   //I64_t *num_edges = count_onmem_edges(list, DF_G_s);
@@ -113,17 +119,26 @@ struct graph_t *graph_construction(struct edgelist_t *list) {
   construct_onm_subgraphs(G, DF_G_s, DF_G_e);
   printf("[elapsed: %6.2fs] finished: construct on-memory sub-graphs\n", get_seconds()-s_time);
 
+#if TAIL_SIGNATURE == 1
+  build_tail_signatures(G);
+  printf("[elapsed: %6.2fs] finished: build tail signatures\n", get_seconds()-s_time);
+#endif
+#if LAYOUT_GRAPH_TAILS == 1
+  layout_graph_tails(G, 1);
+  printf("[elapsed: %6.2fs] finished: layout external tails\n", get_seconds()-s_time);
+#endif
+
 
 
 #if 1
   for (int k = 0; k < DF_G_s->num_files; k++) {
     drop_pagecache_file(DF_G_s->file_info_list[k].fname);
-    drop_pagecache_file(DF_G_e->file_info_list[k].fname);
+    drop_pagecache_file_info(&DF_G_e->file_info_list[k]);
   }
 #endif
 
-  fclose_files(DF_G_s);
-  fclose_files(DF_G_e);
+  close_files(DF_G_s);
+  close_files(DF_G_e);
 
   free_files(DF_E);
   free_files(DF_G_s);
@@ -303,36 +318,15 @@ static I64_t count_onm_node_degree(struct graph_t *G, struct edgelist_t *list, s
     int id = omp_get_thread_num();
     int nodeid = get_numa_nodeid(id);
     int coreid = get_numa_vircoreid(id);
-    //int lcores = get_numa_online_cores(nodeid);
+    int lcores = get_numa_online_cores(nodeid);
     pinned(USE_HYBRID_AFFINITY, id);
     OMP("omp barrier");
 
-    if (coreid == 0) {
-      struct subgraph_t *BG = &G->BG_list[nodeid];
-      I64_t j;
-      FILE *fp_start = DF_G_s->file_info_list[id].fp;
-      I64_t onm_edges;
-      I64_t fs, fe;
-
-      BG->start[0] = 0;
-      fseek(fp_start, 0, SEEK_SET);
-      fread(&fs, sizeof(I64_t), 1, fp_start);
-      for (j=0; j<BG->n; j++) {
-        fread(&fe, sizeof(I64_t), 1, fp_start);
-
-
-        if (fe-fs >= baseline_fully_onmem_edges) {
-          onm_edges = fe-fs;
-        } else if (fe-fs <= max_onmem_edges) {
-          onm_edges = fe-fs;
-        } else {
-          onm_edges = max_onmem_edges;
-        }
-
-        BG->start[j+1] = onm_edges;
-        fs = fe;
-      }
-    }
+    struct subgraph_t *BG = &G->BG_list[nodeid];
+    I64_t ls, le;
+    partial_range(BG->n, 0, lcores, coreid, &ls, &le);
+    if (coreid == 0) BG->start[0] = 0;
+    load_onmem_degrees(&DF_G_s->file_info_list[id], NULL, nodeid, ls, le, &BG->start[ls+1]);
     OMP("omp barrier");
   }
   return fixed;
@@ -405,40 +399,12 @@ static void construct_onm_subgraphs(struct graph_t *G, struct dumpfiles_t *DF_s,
     pinned(USE_HYBRID_AFFINITY, id);
     OMP("omp barrier");
 
-    /* constuct start[] */
-    struct subgraph_t *BG = &G->BG_list[nodeid];
-    I64_t j, k;
-
     /* construct adjacency_list */
+    struct subgraph_t *BG = &G->BG_list[nodeid];
     I64_t ls, le;
-    FILE *fp_start = DF_s->file_info_list[id].fp;
-    FILE *fp_end = DF_e->file_info_list[id].fp;
-    I64_t fs, fe;
-    I64_t e, onm_edges;
-
     partial_range(BG->n, 0, lcores, coreid, &ls, &le);
-
-    fseek(fp_start, sizeof(I64_t)*ls, SEEK_SET);
-    fread(&fs, sizeof(I64_t), 1, fp_start);
-    for (j = ls; j < le; ++j) {
-      fread(&fe, sizeof(I64_t), 1 ,fp_start);
-      fseek(fp_end, sizeof(I64_t)*fs, SEEK_SET);
-
-
-      if (fe-fs >= baseline_fully_onmem_edges) {
-        onm_edges = fe-fs;
-      } else if (fe-fs <= max_onmem_edges) {
-        onm_edges = fe-fs;
-      } else {
-        onm_edges = max_onmem_edges;
-      }
-
-      for (k=0; k<onm_edges; k++) {
-        fread(&e, sizeof(I64_t), 1, fp_end);
-        BG->end[BG->start[j]+k] = e;
-      }
-      fs = fe;
-    }
+    load_onmem_adjacency(&DF_s->file_info_list[id], &DF_e->file_info_list[id], NULL,
+                         nodeid, ls, le, BG->start, BG->end);
     OMP("omp barrier");
     clear_affinity();
   }
@@ -553,56 +519,10 @@ static void update_degree_table(struct graph_t *G) {
   assert( degree_sum == G->m );
 }
 
-static int intdegreecmp(const void *a, const void *b) {
-  const I64_t _a = *(const I64_t *)a;
-  const I64_t _b = *(const I64_t *)b;
-  const I64_t _ia = degree_table[_a];
-  const I64_t _ib = degree_table[_b];
-#if 1
-  /* descending order */
-  /* Intel(R) Xeon(R) CPU E5-4640 2.40GHz */
-  /*    Kronecker SCALE=26, edgefactor=16 */
-  if (_ia > _ib) return -1;
-  if (_ia < _ib) return  1;
-  if ( _a >  _b) return -1;
-  if ( _a <  _b) return  1;
-#else
-  /* ascending order */
-  /* Intel(R) Xeon(R) CPU E5-4640 2.40GHz */
-  /*    Kronecker SCALE=26, edgefactor=16 */
-  if (_ia < _ib) return -1;
-  if (_ia > _ib) return  1;
-  if ( _a <  _b) return -1;
-  if ( _a >  _b) return  1;
-#endif
-  return 0;
-}
-
 static void sort_adjacency_list_by_degree(struct graph_t *G) {
-  I64_t duplicates = 0;
   const double t1 = get_seconds();
-  OMP("omp parallel num_threads(get_numa_num_threads()) reduction(+:duplicates)") {
-    int id = omp_get_thread_num();
-    int nodeid = get_numa_nodeid(id);
-    int coreid = get_numa_vircoreid(id);
-    int lcores = get_numa_online_cores(nodeid);
-    pinned(USE_HYBRID_AFFINITY, id);
-    I64_t ls, le;
-    struct subgraph_t *BG = &G->BG_list[nodeid];
-    partial_range(BG->n, 0, lcores, coreid, &ls, &le);
-    for (I64_t j = ls; j < le; ++j) {
-      I64_t bs = BG->start[j], be = BG->start[j+1], dg = be-bs;
-      if (dg) {
-        I64_t *array = &BG->end[bs];
-        I64_t uniq_dg = uniq(array, dg, sizeof(I64_t), qsort, intdegreecmp);
-        for (I64_t i = uniq_dg; i < dg; ++i) array[i] = -1; /* filled -1 */
-        duplicates += dg - uniq_dg;
-      }
-    }
-
-    OMP("omp barrier");
-    clear_affinity();
-  }
+  const I64_t duplicates = sort_adjacency_lists_by_degree(G->BG_list, G->num_graphs, 1,
+                                                          G->n, degree_table, NULL);
   const double t2 = get_seconds();
 
   printf("found %lld duplicated edges (%.3f %%) (%.3f seconds)\n",
@@ -618,40 +538,12 @@ static void extract_duplicated_edges(struct graph_t *G) {
   sort_adjacency_list_by_degree(G);
 
   const double t1 = get_seconds();
-  OMP("omp parallel num_threads(get_numa_num_threads())") {
-    int id = omp_get_thread_num();
-    int nodeid = get_numa_nodeid(id);
-    int coreid = get_numa_vircoreid(id);
-    pinned(USE_HYBRID_AFFINITY, id);
-    if (coreid == 0) {
-      I64_t crr;
-      /* Backward Graph */
-      crr = 0;
-      struct subgraph_t *BG = &G->BG_list[nodeid];
-      for (I64_t j = 0; j < BG->n; ++j) {
-        const I64_t ls = BG->start[j], le = BG->start[j+1];
-        BG->start[j] = crr;
-        for (I64_t w = ls; w < le; ++w) {
-          I64_t v = BG->end[w];
-          if (v != -1) {
-            BG->end[crr++] = v;
-          }
-        }
-      }
-      BG->start[BG->n] = crr;
-      BG->m = crr;
-    }
-  }
-
-  /* update # of edges */
-  G->m = 0;
-  for (int k = 0; k < G->num_graphs; ++k) {
-    G->m += G->BG_list[k].m;
-  }
+  /* Backward Graph, and update # of edges */
+  G->m = compact_adjacency_lists(G->BG_list, G->num_graphs, 1, 0);
   update_degree_table(G);
 
   const double t2 = get_seconds();
-  printf("extract duplicated edges (#threads=1, %.3f seconds)\n", t2-t1);
+  printf("extract duplicated edges (#threads=%d, %.3f seconds)\n", get_numa_num_threads(), t2-t1);
 
   /* dump degree */
   dump_degree_distribution(G);
@@ -769,6 +661,12 @@ int dump_graph(const char *filename, struct graph_t *G) {
  * ------------------------------------------------------------ */
 void free_graph(struct graph_t *G) {
   int k;
+#if TAIL_SIGNATURE == 1
+  free_tail_signatures(G);
+#endif
+#if LAYOUT_GRAPH_TAILS == 1
+  free_tail_layout(G);
+#endif
   for (k = 0; k < G->num_graphs; ++k) {
     lfree(G->pool[k]);
   }
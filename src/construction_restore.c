@@ -41,18 +41,22 @@
 #include "generation.h"
 #include "construction.h"
 #include "atomic.h"
+#include "sort_adjacency.h"
 
 #include "dump.h"
 
-static I64_t *count_onmem_edges(struct edgelist_t *list, struct dumpfiles_t *DF_G_s);
+static I64_t *count_onmem_edges(struct edgelist_t *list, struct dumpfiles_t *DF_G_s,
+                                struct placement_map_t *PM);
 
 static struct graph_t *allocate_graph(struct edgelist_t *list, I64_t num_nodes, I64_t *num_edges);
 
-static I64_t count_onm_node_degree(struct graph_t *G, struct edgelist_t *list, struct dumpfiles_t *DF_G_s);
+static I64_t count_onm_node_degree(struct graph_t *G, struct edgelist_t *list, struct dumpfiles_t *DF_G_s,
+                                   struct placement_map_t *PM);
 
 static int parallel_prefix_sum(struct graph_t *G);
 
-static void construct_onm_subgraphs(struct graph_t *G, struct dumpfiles_t *DF_s, struct dumpfiles_t *DF_e);
+static void construct_onm_subgraphs(struct graph_t *G, struct dumpfiles_t *DF_s, struct dumpfiles_t *DF_e,
+                                    struct placement_map_t *PM);
 
 static void extract_duplicated_edges(struct graph_t *G);
 
@@ -60,15 +64,26 @@ static void extract_duplicated_edges(struct graph_t *G);
 struct graph_t *graph_construction(struct edgelist_t *list) {
   struct graph_t *G = NULL;
 
+#if COMPRESS_GRAPH_END == 1
+  /* compressed end files, unless they exist */
+  compress_graph_end(0);
+#endif
+
   struct dumpfiles_t *DF_G_s = NULL;
   struct dumpfiles_t *DF_G_e = NULL;
   DF_G_s = init_dumpfile_info_graph("", 1, 0);
   DF_G_e = init_dumpfile_info_graph("", 0, 0);
-  fopen_files_readmode(DF_G_s);
-  fopen_files_readmode(DF_G_e);
+  open_files_readmode(DF_G_s);
+  open_files_readmode(DF_G_e);
+
+  /* profile-guided placement */
+  struct placement_map_t *PM = NULL;
+  if ( getenvi((char *)ENV_PLACEMENT_MAP, 0) ) {
+    PM = load_placement_map(list->num_nodes, list->num_lists);
+  }
 
   double t1_cnt = get_seconds();
-  I64_t *num_edges = count_onmem_edges(list, DF_G_s);
+  I64_t *num_edges = count_onmem_edges(list, DF_G_s, PM);
   double t2_cnt = get_seconds();
   printf("count on-memory edges takes %.3lf seconds\n", t2_cnt - t1_cnt);
 
@@ -92,15 +107,24 @@ struct graph_t *graph_construction(struct edgelist_t *list) {
   printf("on-memory graph construction without self-loop and duplicated-edges ... \n");
   const double s_time = get_seconds();
 
-  count_onm_node_degree(G, list, DF_G_s);
+  count_onm_node_degree(G, list, DF_G_s, PM);
   printf("[elapsed: %6.2fs] finished: count on-memory each vertex degree\n", get_seconds()-s_time);
 
   parallel_prefix_sum(G);
   printf("[elapsed: %6.2fs] finished: parallel prefix sum\n", get_seconds()-s_time);
 
-  construct_onm_subgraphs(G, DF_G_s, DF_G_e);
+  construct_onm_subgraphs(G, DF_G_s, DF_G_e, PM);
   printf("[elapsed: %6.2fs] finished: construct on-memory sub-graphs\n", get_seconds()-s_time);
 
+#if TAIL_SIGNATURE == 1
+  build_tail_signatures(G);
+  printf("[elapsed: %6.2fs] finished: build tail signatures\n", get_seconds()-s_time);
+#endif
+#if LAYOUT_GRAPH_TAILS == 1
+  layout_graph_tails(G, 0);
+  printf("[elapsed: %6.2fs] finished: layout external tails\n", get_seconds()-s_time);
+#endif
+
 #if 0
   extract_duplicated_edges(G);
   printf("[elapsed: %6.2fs] finished: extracting duplicated edges\n", get_seconds()-s_time);
@@ -113,16 +137,17 @@ struct graph_t *graph_construction(struct edgelist_t *list) {
   printf("drop graph's pagecache\n");
   for (int k = 0; k < DF_G_s->num_files; k += DF_G_s->num_files/G->num_graphs) {
     drop_pagecache_file(DF_G_s->file_info_list[k].fname);
-    drop_pagecache_file(DF_G_e->file_info_list[k].fname);
+    drop_pagecache_file_info(&DF_G_e->file_info_list[k]);
   }
 #endif
 
 
-  fclose_files(DF_G_s);
-  fclose_files(DF_G_e);
+  close_files(DF_G_s);
+  close_files(DF_G_e);
 
   free_files(DF_G_s);
   free_files(DF_G_e);
+  free_placement_map(PM);
 
 
   printf("[elapsed: %6.2fs] finished: close and free files\n", get_seconds()-s_time);
@@ -150,7 +175,8 @@ struct graph_t *graph_construction(struct edgelist_t *list) {
 /* ------------------------------------------------------------
  * count_onmem_edges
  * ------------------------------------------------------------ */
-static I64_t *count_onmem_edges(struct edgelist_t *list, struct dumpfiles_t *DF_G_s) {
+static I64_t *count_onmem_edges(struct edgelist_t *list, struct dumpfiles_t *DF_G_s,
+                                struct placement_map_t *PM) {
 
   I64_t *total_onm_edges_list;
   assert( total_onm_edges_list = (I64_t *)calloc(list->num_lists, sizeof(I64_t)) );
@@ -169,38 +195,14 @@ static I64_t *count_onmem_edges(struct edgelist_t *list, struct dumpfiles_t *DF_
     int id = omp_get_thread_num();
     int nodeid = get_numa_nodeid(id);
     int coreid = get_numa_vircoreid(id);
-    //int lcores = get_numa_online_cores(nodeid);
+    int lcores = get_numa_online_cores(nodeid);
     pinned(USE_HYBRID_AFFINITY, id);
     OMP("omp barrier");
 
-    if (coreid == 0) {
-      I64_t k, *total_onm_edges = &total_onm_edges_list[nodeid];
-      I64_t fe, fs;
-      FILE *fp_start = DF_G_s->file_info_list[id].fp;
-      I64_t num_vertices = offset[nodeid+1] - offset[nodeid];
-      //I64_t num_vertices = list->IJ_list[nodeid].length;
-      //I64_t buf[2];
-
-      *total_onm_edges = 0;
-      fseek(fp_start, 0, SEEK_SET);
-
-      fread(&fs, sizeof(I64_t), 1, fp_start);
-      for (k=0; k<num_vertices; k++) {
-        fread(&fe, sizeof(I64_t), 1, fp_start);
-
-
-        if (fe-fs >= baseline_fully_onmem_edges) {
-          *total_onm_edges += fe-fs;
-        } else if (fe-fs <= max_onmem_edges) {
-          *total_onm_edges += fe-fs;
-        } else {
-          *total_onm_edges += max_onmem_edges;
-        }
-
-        fs = fe;
-
-      }
-    }
+    I64_t ls, le;
+    partial_range(offset[nodeid+1] - offset[nodeid], 0, lcores, coreid, &ls, &le);
+    const I64_t onm_edges = load_onmem_degrees(&DF_G_s->file_info_list[id], PM, nodeid, ls, le, NULL);
+    SYNC_FETCH_AND_ADD(&total_onm_edges_list[nodeid], onm_edges);
   }
 
   return total_onm_edges_list;
@@ -273,43 +275,23 @@ static struct graph_t *allocate_graph(struct edgelist_t *list, I64_t num_nodes,
 /* ------------------------------------------------------------
  * count_onm_node_degree
  * ------------------------------------------------------------ */
-static I64_t count_onm_node_degree(struct graph_t *G, struct edgelist_t *list, struct dumpfiles_t *DF_G_s) {
+static I64_t count_onm_node_degree(struct graph_t *G, struct edgelist_t *list, struct dumpfiles_t *DF_G_s,
+                                   struct placement_map_t *PM) {
   I64_t fixed = 0;
 
   OMP("omp parallel num_threads(get_numa_num_threads())") {
     int id = omp_get_thread_num();
     int nodeid = get_numa_nodeid(id);
     int coreid = get_numa_vircoreid(id);
-    //int lcores = get_numa_online_cores(nodeid);
+    int lcores = get_numa_online_cores(nodeid);
     pinned(USE_HYBRID_AFFINITY, id);
     OMP("omp barrier");
 
-    if (coreid == 0) {
-      struct subgraph_t *BG = &G->BG_list[nodeid];
-      I64_t j;
-      FILE *fp_start = DF_G_s->file_info_list[id].fp;
-      I64_t onm_edges;
-      I64_t fs, fe;
-
-      BG->start[0] = 0;
-      fseek(fp_start, 0, SEEK_SET);
-      fread(&fs, sizeof(I64_t), 1, fp_start);
-      for (j=0; j<BG->n; j++) {
-        fread(&fe, sizeof(I64_t), 1, fp_start);
-
-
-        if (fe-fs >= baseline_fully_onmem_edges) {
-          onm_edges = fe-fs;
-        } else if (fe-fs <= max_onmem_edges) {
-          onm_edges = fe-fs;
-        } else {
-          onm_edges = max_onmem_edges;
-        }
-
-        BG->start[j+1] = onm_edges;
-        fs = fe;
-      }
-    }
+    struct subgraph_t *BG = &G->BG_list[nodeid];
+    I64_t ls, le;
+    partial_range(BG->n, 0, lcores, coreid, &ls, &le);
+    if (coreid == 0) BG->start[0] = 0;
+    load_onmem_degrees(&DF_G_s->file_info_list[id], PM, nodeid, ls, le, &BG->start[ls+1]);
     OMP("omp barrier");
   }
 
@@ -378,7 +360,8 @@ static int parallel_prefix_sum(struct graph_t *G) {
 /* ------------------------------------------------------------
  * construct_onm_subgraphs
  * ------------------------------------------------------------ */
-static void construct_onm_subgraphs(struct graph_t *G, struct dumpfiles_t *DF_s, struct dumpfiles_t *DF_e) {
+static void construct_onm_subgraphs(struct graph_t *G, struct dumpfiles_t *DF_s, struct dumpfiles_t *DF_e,
+                                    struct placement_map_t *PM) {
   OMP("omp parallel num_threads(get_numa_num_threads())") {
     int id = omp_get_thread_num();
     int nodeid = get_numa_nodeid(id);
@@ -387,40 +370,12 @@ static void construct_onm_subgraphs(struct graph_t *G, struct dumpfiles_t *DF_s,
     pinned(USE_HYBRID_AFFINITY, id);
     OMP("omp barrier");
 
-    /* constuct start[] */
-    struct subgraph_t *BG = &G->BG_list[nodeid];
-    I64_t j, k;
-
     /* construct adjacency_list */
+    struct subgraph_t *BG = &G->BG_list[nodeid];
     I64_t ls, le;
-    FILE *fp_start = DF_s->file_info_list[id].fp;
-    FILE *fp_end = DF_e->file_info_list[id].fp;
-    I64_t fs, fe;
-    I64_t e, onm_edges;
-
     partial_range(BG->n, 0, lcores, coreid, &ls, &le);
-
-    fseek(fp_start, sizeof(I64_t)*ls, SEEK_SET);
-    fread(&fs, sizeof(I64_t), 1, fp_start);
-    for (j = ls; j < le; ++j) {
-      fread(&fe, sizeof(I64_t), 1 ,fp_start);
-      fseek(fp_end, sizeof(I64_t)*fs, SEEK_SET);
-
-
-      if (fe-fs >= baseline_fully_onmem_edges) {
-        onm_edges = fe-fs;
-      } else if (fe-fs <= max_onmem_edges) {
-        onm_edges = fe-fs;
-      } else {
-        onm_edges = max_onmem_edges;
-      }
-
-      for (k=0; k<onm_edges; k++) {
-        fread(&e, sizeof(I64_t), 1, fp_end);
-        BG->end[BG->start[j]+k] = e;
-      }
-      fs = fe;
-    }
+    load_onmem_adjacency(&DF_s->file_info_list[id], &DF_e->file_info_list[id], PM,
+                         nodeid, ls, le, BG->start, BG->end);
     OMP("omp barrier");
     clear_affinity();
   }
@@ -546,40 +501,12 @@ static void extract_duplicated_edges(struct graph_t *G) {
   sort_adjacency_list_by_degree(G);
 
   const double t1 = get_seconds();
-  OMP("omp parallel num_threads(get_numa_num_threads())") {
-    int id = omp_get_thread_num();
-    int nodeid = get_numa_nodeid(id);
-    int coreid = get_numa_vircoreid(id);
-    pinned(USE_HYBRID_AFFINITY, id);
-    if (coreid == 0) {
-      I64_t crr;
-      /* Backward Graph */
-      crr = 0;
-      struct subgraph_t *BG = &G->BG_list[nodeid];
-      for (I64_t j = 0; j < BG->n; ++j) {
-        const I64_t ls = BG->start[j], le = BG->start[j+1];
-        BG->start[j] = crr;
-        for (I64_t w = ls; w < le; ++w) {
-          I64_t v = BG->end[w];
-          if (v != -1) {
-            BG->end[crr++] = v;
-          }
-        }
-      }
-      BG->start[BG->n] = crr;
-      BG->m = crr;
-    }
-  }
-
-  /* update # of edges */
-  G->m = 0;
-  for (int k = 0; k < G->num_graphs; ++k) {
-    G->m += G->BG_list[k].m;
-  }
+  /* Backward Graph, and update # of edges */
+  G->m = compact_adjacency_lists(G->BG_list, G->num_graphs, 1, 0);
   update_degree_table(G);
 
   const double t2 = get_seconds();
-  printf("extract duplicated edges (#threads=1, %.3f seconds)\n", t2-t1);
+  printf("extract duplicated edges (#threads=%d, %.3f seconds)\n", get_numa_num_threads(), t2-t1);
 
   /* dump degree */
   dump_degree_distribution(G);
@@ -697,6 +624,12 @@ int dump_graph(const char *filename, struct graph_t *G) {
  * ------------------------------------------------------------ */
 void free_graph(struct graph_t *G) {
   int k;
+#if TAIL_SIGNATURE == 1
+  free_tail_signatures(G);
+#endif
+#if LAYOUT_GRAPH_TAILS == 1
+  free_tail_layout(G);
+#endif
   for (k = 0; k < G->num_graphs; ++k) {
     lfree(G->pool[k]);
   }
@@ -33,14 +33,18 @@
 #include <assert.h>
 #include <string.h>
 #include <math.h>
+#include <time.h>
 
 #include <unistd.h>
 #include <sys/types.h>
 #include <sys/stat.h>
 #include <fcntl.h>
 #include <sys/mman.h>
+#include <sched.h>
+#include <pthread.h>
 
 #include "dump.h"
+#include "atomic.h"
 #include "common.h"
 #include "generation.h"
 #include "graph_generator.h"
@@ -135,6 +139,15 @@ void get_fname_base(char *fname_base_result, const char **key_list)
   free_config_list(config_list);
 }
 
+int get_farmem_nodeid(void)
+{
+  const char *key_list[1] = { CONFIG_FARMEM };
+  struct config_list_t config_list = make_configlist_from_conffile(get_conf_file_name(), key_list, 1);
+  const int nodeid = (config_list.value_list[0]) ? atoi(config_list.value_list[0]) : -1;
+  free_config_list(config_list);
+  return nodeid;
+}
+
 void get_fname_base_for_single_key(char *fname_base_result, const char *key)
 {
   const char *key_list[1];
@@ -146,6 +159,64 @@ void get_fname_base_for_single_key(char *fname_base_result, const char *key)
 
 
 
+/* ------------------------------------------------------------
+* I/O statistics
+* ------------------------------------------------------------ */
+__thread struct io_stat_t *io_stat = NULL;
+static __thread int is_io_worker = 0;
+
+double monotonic_seconds(void)
+{
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+// 4 log-linear buckets per power of two
+int io_hist_bucket(unsigned long x)
+{
+  if (x < 4) return (int)x;
+  const int msb = 63 - __builtin_clzl(x);
+  return MIN(4 * (msb - 1) + (int)((x >> (msb - 2)) & 3), IO_HIST_BUCKETS - 1);
+}
+
+// lower bound of bucket b
+unsigned long io_hist_value(int b)
+{
+  if (b < 4) return (unsigned long)b;
+  return (4UL + (b & 3)) << (b / 4 - 1);
+}
+
+unsigned long io_hist_percentile(const long *hist, double p)
+{
+  long total = 0, sum = 0;
+  int b;
+  for (b = 0; b < IO_HIST_BUCKETS; ++b) total += hist[b];
+  if (total == 0) return 0;
+  for (b = 0; b < IO_HIST_BUCKETS - 1; ++b) {
+    sum += hist[b];
+    if (sum >= p * total) break;
+  }
+  return io_hist_value(b);
+}
+
+#if PROFILE_IO == 1
+static void record_io_request(size_t len, double seconds, long syscalls)
+{
+  struct io_stat_t *S = io_stat;
+  if (!S) return ;
+  const long nsec = (long)(seconds * 1e9);
+  __sync_fetch_and_add(&S->requests, 1);
+  __sync_fetch_and_add(&S->syscalls, syscalls);
+  __sync_fetch_and_add(&S->bytes, (long)len);
+  __sync_fetch_and_add(&S->io_nsec, nsec);
+  if (!is_io_worker) __sync_fetch_and_add(&S->blocked_nsec, nsec);
+  __sync_fetch_and_add(&S->size_hist[io_hist_bucket(len)], 1);
+  __sync_fetch_and_add(&S->latency_hist[io_hist_bucket(nsec)], 1);
+}
+#endif
+
+
 /* ------------------------------------------------------------
 * allocate buffer for read
 * ------------------------------------------------------------ */
@@ -167,7 +238,10 @@ struct dump_buffer_t *alloc_dump_buffer(int num_buffer) {
   t1 = get_seconds();
   for (k = 0; k < BF->num_buffer; ++k) {
     size_t sz = 0;
-sz += (DUMP_BUF_LENGTH + 1) * sizeof(I64_t) + spacing; // end
+sz += DUMP_BUF_SLOT_SIZE * DUMP_BUF_SLOTS + spacing;     // end (start/end windows for O_DIRECT)
+#if DIRECT_IO_BFS == 1
+sz += DIRECT_IO_BLOCK_SIZE;                               // alignment
+#endif
 sz  = ROUNDUP( sz, hugepage_size() );
 BF->buffer_pool[k] = lmalloc(sz, get_numa_nodeid(k));
 total_alloc_sz += BF->buffer_pool[k].memsize;
@@ -188,7 +262,12 @@ printf("numa node local allocation(%.2f MB   %d allocation's) takes %.3f seconds
 /*  representation */
 for (k = 0; k < BF->num_buffer; ++k) {
   BF->buffer_list[k].length = DUMP_BUF_LENGTH;
+#if DIRECT_IO_BFS == 1
+  // lmalloc falls back to malloc without affinity
+  BF->buffer_list[k].buf = (I64_t *)ROUNDUP((size_t)BF->buffer_pool[k].pool, DIRECT_IO_BLOCK_SIZE);
+#else
   BF->buffer_list[k].buf = (I64_t *)&(BF->buffer_pool[k].pool[0]);
+#endif
 }
 
 return BF;
@@ -255,6 +334,111 @@ void free_dump_buffer(struct dump_buffer_t *BF) {
 }
 
 
+/* ------------------------------------------------------------
+* block aligned read with user-level cache
+* ------------------------------------------------------------ */
+void init_direct_cache(struct direct_cache_t *C, void *buf, size_t size)
+{
+  assert( ((size_t)buf & (DIRECT_IO_BLOCK_SIZE-1)) == 0 );
+  C->buf   = (unsigned char *)buf;
+  C->size  = size & ~(DIRECT_IO_BLOCK_SIZE-1);
+  C->off   = 0;
+  C->valid = 0;
+}
+
+// returns a pointer to file data [pos, pos+len).
+// a miss reads the enclosing blocks and up to DIRECT_IO_WINDOW_SIZE ahead,
+// so that the following tails (vertices are visited in ID order) hit.
+void *read_direct_cached(const struct file_info_t *finfo, struct direct_cache_t *C, size_t pos, size_t len)
+{
+  if ( C->off <= pos && pos + len <= C->off + C->valid ) {
+    return &C->buf[pos - C->off];
+  }
+
+  const size_t aligned_off  = pos & ~(DIRECT_IO_BLOCK_SIZE-1);
+  const size_t aligned_size = ROUNDUP(pos + len - aligned_off, DIRECT_IO_BLOCK_SIZE);
+  const size_t read_size    = MIN(C->size, aligned_size + DIRECT_IO_WINDOW_SIZE);
+  assert( aligned_size <= C->size );
+
+  size_t readed_length = pread_file(finfo, C->buf, read_size, aligned_off);
+  if (readed_length < pos + len - aligned_off) {
+    fprintf(stderr, "[error] read_direct_cached: %s, pos=%zu, len=%zu\n", finfo->fname, pos, len);
+    exit(1);
+  }
+  C->off   = aligned_off;
+  C->valid = readed_length;
+
+  return &C->buf[pos - aligned_off];
+}
+
+// reads [pos, pos+len) bytes through the user-level cache if C is given (O_DIRECT),
+// otherwise into buf.
+void *read_extent(const struct file_info_t *finfo, struct direct_cache_t *C, void *buf, size_t pos, size_t len)
+{
+  if (finfo->farmem && !finfo->cindex) {
+    if (pos + len > finfo->farmem_size) {
+      fprintf(stderr, "[error] read_extent: %s, pos=%zu, len=%zu\n", finfo->fname, pos, len);
+      exit(1);
+    }
+#if PROFILE_IO == 1
+    const double t1 = monotonic_seconds();
+#endif
+#if NVM_EMULATION == 1
+    struct nvm_request_t R;
+    begin_nvm_request(finfo, len, &R);
+    end_nvm_request(&R);
+#endif
+#if PROFILE_IO == 1
+    record_io_request(len, monotonic_seconds() - t1, 0);
+#endif
+    return &finfo->farmem[pos];
+  }
+  if (C) {
+    return read_direct_cached(finfo, C, pos, len);
+  }
+
+  size_t readed_length = pread_file(finfo, buf, len, pos);
+  if (readed_length != len) {
+    fprintf(stderr, "[error] read_extent: %s, pos=%zu, len=%zu\n", finfo->fname, pos, len);
+    exit(1);
+  }
+  return buf;
+}
+
+
+/* ------------------------------------------------------------
+* coalesced read of sorted extents
+* ------------------------------------------------------------ */
+// reads ext[r], ..., ext[q-1] by a single request and returns q.
+// the next extent is merged while the gap to it is at most max_gap (#I64_t)
+// and the merged request fits in the buffer. max_gap < 0 disables merging.
+I64_t read_coalesced_extents(const struct file_info_t *finfo, struct direct_cache_t *C, I64_t *buf, I64_t buf_length,
+                             struct read_extent_t *ext, I64_t r, I64_t num_ext, I64_t max_gap)
+{
+  const I64_t cap = (C) ? (I64_t)((C->size - 2*DIRECT_IO_BLOCK_SIZE) / sizeof(I64_t)) : buf_length;
+  const I64_t head = ext[r].pos;
+  I64_t tail = ext[r].pos + ext[r].len;
+  I64_t q;
+
+  if (ext[r].len > cap) {
+    ext[r].data = NULL;
+    return r+1;
+  }
+
+  for (q = r+1; q < num_ext && max_gap >= 0; ++q) {
+    const I64_t next_tail = (ext[q].pos + ext[q].len > tail) ? ext[q].pos + ext[q].len : tail;
+    if (ext[q].pos - tail > max_gap || next_tail - head > cap) break;
+    tail = next_tail;
+  }
+
+  I64_t *data = (I64_t *)read_extent(finfo, C, buf, sizeof(I64_t)*head, sizeof(I64_t)*(tail-head));
+  for (I64_t j = r; j < q; ++j) {
+    ext[j].data = &data[ext[j].pos - head];
+  }
+  return q;
+}
+
+
 /* ------------------------------------------------------------
 * allcate dumpfile_t and set file name
 * ------------------------------------------------------------ */
@@ -311,7 +495,7 @@ struct dumpfiles_t *init_dumpfile_info_graph(char *suffix, int is_start, int is_
   DF->file_info_list = (struct file_info_t *)calloc(num_files,
     sizeof(struct file_info_t));
   int k;
-  char *prefix = (is_start) ? "%.128s_BG_start_SCALE%d_%d_%.128" : "%.128s_BG_end_SCALE%d_%d_%.128";
+  char *prefix = (is_start) ? "%.128s_BG_start_SCALE%d_%d_%.128s" : "%.128s_BG_end_SCALE%d_%d_%.128s";
 
   for (k=0; k<num_files; k++) {
     int nodeid = (is_single_thrd) ? k : get_numa_nodeid(k);
@@ -322,6 +506,27 @@ struct dumpfiles_t *init_dumpfile_info_graph(char *suffix, int is_start, int is_
       nodeid,
       suffix);
 
+#if STRIPE_GRAPH_END == 1
+    // [fname_base(device d)]_BG_end_SCALE[scale]_[numa node ID]_stripe[d]_[suffix]
+    if (!is_start) {
+      struct file_info_t *finfo = &DF->file_info_list[k];
+      finfo->num_stripes  = fname_base_list.num_fname_bases;
+      finfo->stripe_first = nodeid % finfo->num_stripes;
+      assert( finfo->stripe_fd = (int *)calloc(finfo->num_stripes, sizeof(int)) );
+      assert( finfo->stripe_fname = (char **)calloc(finfo->num_stripes, sizeof(char *)) );
+      for (int d = 0; d < finfo->num_stripes; ++d) {
+        finfo->stripe_fd[d] = -1;
+        assert( finfo->stripe_fname[d] = (char *)calloc(MAX_FNAME, sizeof(char)) );
+        sprintf(finfo->stripe_fname[d],
+          "%.128s_BG_end_SCALE%d_%d_stripe%d_%.128s",
+          fname_base_list.fname_bases[d],
+          SCALE,
+          nodeid,
+          d,
+          suffix);
+      }
+    }
+#endif
   }
 
   return DF;
@@ -411,6 +616,35 @@ struct dumpfiles_t *init_dumpfile_info_edgelist_bucket(char *suffix, int num_buc
 
 }
 
+// set dump file name to dumpfiles_t for placement profile
+// [fname_base]_BG_plcmt_SCALE[scale]_[numa node ID]_[suffix]
+struct dumpfiles_t *init_dumpfile_info_placement(char *suffix)
+{
+  int num_files = get_numa_online_nodes();
+
+  char *fname_base = CALLOCA(MAX_FNAME);
+  get_fname_base_for_single_key(fname_base, CONFIG_GRAPH);
+  struct fname_base_list_t fname_base_list = get_fname_base_list(fname_base);
+
+  // allocate file info list and set basic info
+  struct dumpfiles_t *DF = (struct dumpfiles_t *)calloc(1, sizeof(struct dumpfiles_t));
+  DF->num_files = num_files;
+  DF->file_info_list = (struct file_info_t *)calloc(num_files, sizeof(struct file_info_t));
+
+  int k;
+  for (k=0; k<num_files; k++) {
+    sprintf(DF->file_info_list[k].fname,
+      "%.128s_BG_plcmt_SCALE%d_%d_%.128s",
+      fname_base_list.fname_bases[k % fname_base_list.num_fname_bases],
+      SCALE,
+      k,
+      suffix);
+  }
+  free_fname_base_list(fname_base_list);
+
+  return DF;
+}
+
 /* ------------------------------------------------------------
 * flush files
 * ------------------------------------------------------------ */
@@ -425,10 +659,155 @@ void flush_files(struct dumpfiles_t *DF) {
 * free files
 * ------------------------------------------------------------ */
 void free_files(struct dumpfiles_t *DF) {
+  for (int k = 0; k < DF->num_files; ++k) {
+    struct file_info_t *finfo = &DF->file_info_list[k];
+    if (finfo->is_farmem_owner) {
+      munmap(finfo->farmem, ROUNDUP(MAX(finfo->farmem_size, 1), DIRECT_IO_BLOCK_SIZE));
+    }
+    for (int d = 0; d < finfo->num_stripes; ++d) {
+      free(finfo->stripe_fname[d]);
+    }
+    free(finfo->stripe_fname);
+    free(finfo->stripe_fd);
+  }
+  for (int k = 0; k < DF->num_cindex; ++k) {
+    free(DF->cindex_list[k].block_pos);
+  }
+  free(DF->cindex_list);
   free(DF->file_info_list);
   free(DF);
 }
 
+/* ------------------------------------------------------------
+* NVM device emulation
+* ------------------------------------------------------------ */
+#if NVM_EMULATION == 1
+struct nvm_device_t {
+  char name[256];
+  pthread_mutex_t lock;
+  pthread_cond_t released;
+  int inflight;
+  double next_free;   /* end of the last reserved transfer */
+};
+static struct nvm_device_t nvm_devices[NVM_EMU_MAX_DEVICES];
+static int num_nvm_devices = 0;
+static pthread_mutex_t nvm_devices_lock = PTHREAD_MUTEX_INITIALIZER;
+static double nvm_latency   = NVM_EMU_LATENCY * 1e-6;     /* seconds */
+static double nvm_bandwidth = NVM_EMU_BANDWIDTH * 1e6;    /* bytes/second */
+static int nvm_queue_depth  = NVM_EMU_QUEUE_DEPTH;
+
+// returns the emulated device of the name, registering it at first
+static int nvm_device(const char *name)
+{
+  int d;
+  pthread_mutex_lock(&nvm_devices_lock);
+  if (num_nvm_devices == 0) {
+    nvm_latency     = getenvi((char *)ENV_NVM_EMU_LATENCY, NVM_EMU_LATENCY) * 1e-6;
+    nvm_bandwidth   = MAX(getenvi((char *)ENV_NVM_EMU_BANDWIDTH, NVM_EMU_BANDWIDTH), 1) * 1e6;
+    nvm_queue_depth = MAX(getenvi((char *)ENV_NVM_EMU_QUEUE_DEPTH, NVM_EMU_QUEUE_DEPTH), 1);
+    printf("[NVM emulation] %.1f us, %.0f MB/s, queue depth %d per device\n",
+           nvm_latency * 1e6, nvm_bandwidth * 1e-6, nvm_queue_depth);
+  }
+  for (d = 0; d < num_nvm_devices; ++d) {
+    if ( !strcmp(nvm_devices[d].name, name) ) break;
+  }
+  if (d == num_nvm_devices) {
+    assert( d < NVM_EMU_MAX_DEVICES );
+    struct nvm_device_t *D = &nvm_devices[d];
+    strncpy(D->name, name, sizeof(D->name) - 1);
+    pthread_mutex_init(&D->lock, NULL);
+    pthread_cond_init(&D->released, NULL);
+    D->inflight  = 0;
+    D->next_free = 0.0;
+    ++num_nvm_devices;
+  }
+  pthread_mutex_unlock(&nvm_devices_lock);
+  return d;
+}
+
+// the directory of a file is its device
+static int nvm_device_of_path(const char *fname)
+{
+  char dir[256] = ".";
+  const char *slash = strrchr(fname, '/');
+  if (slash) {
+    const size_t len = MIN((size_t)(slash - fname), sizeof(dir) - 1);
+    memcpy(dir, fname, len);
+    dir[(len) ? len : 1] = '\0';
+  }
+  return nvm_device(dir);
+}
+
+void begin_nvm_request(const struct file_info_t *finfo, size_t len, struct nvm_request_t *R)
+{
+  struct nvm_device_t *D = &nvm_devices[finfo->emu_dev];
+  R->dev = finfo->emu_dev;
+  pthread_mutex_lock(&D->lock);
+  while (D->inflight >= nvm_queue_depth) {
+    pthread_cond_wait(&D->released, &D->lock);
+  }
+  ++D->inflight;
+  D->next_free = MAX(D->next_free, monotonic_seconds()) + len / nvm_bandwidth;
+  R->deadline = D->next_free + nvm_latency;
+  pthread_mutex_unlock(&D->lock);
+}
+
+void end_nvm_request(struct nvm_request_t *R)
+{
+  struct nvm_device_t *D = &nvm_devices[R->dev];
+  double rest;
+  while ((rest = R->deadline - monotonic_seconds()) > 0) {
+    if (rest > 1e-4) {   // sleep, then spin the last 50 us
+      rest -= 5e-5;
+      struct timespec ts = { (time_t)rest, (long)((rest - (time_t)rest) * 1e9) };
+      nanosleep(&ts, NULL);
+    }
+  }
+  pthread_mutex_lock(&D->lock);
+  --D->inflight;
+  pthread_cond_signal(&D->released);
+  pthread_mutex_unlock(&D->lock);
+}
+#endif
+
+
+/* ------------------------------------------------------------
+* open/close a file (all stripes of a striped file)
+* ------------------------------------------------------------ */
+int open_file_info(struct file_info_t *finfo, int flags)
+{
+#if NVM_EMULATION == 1
+  finfo->emu_dev = nvm_device_of_path( (finfo->num_stripes == 0) ? finfo->fname
+                                       : finfo->stripe_fname[finfo->stripe_first] );
+#endif
+  if (finfo->num_stripes == 0) {
+    finfo->fd = open(finfo->fname, flags, S_IREAD|S_IWRITE);
+    return finfo->fd;
+  }
+
+  int is_opened = 1;
+  for (int d = 0; d < finfo->num_stripes; ++d) {
+    finfo->stripe_fd[d] = open(finfo->stripe_fname[d], flags, S_IREAD|S_IWRITE);
+    if (finfo->stripe_fd[d] == -1) is_opened = 0;
+  }
+  finfo->fd = (is_opened) ? finfo->stripe_fd[finfo->stripe_first] : -1;
+  return finfo->fd;
+}
+
+void close_file_info(struct file_info_t *finfo)
+{
+  if (finfo->num_stripes == 0) {
+    close(finfo->fd);
+    return ;
+  }
+
+  for (int d = 0; d < finfo->num_stripes; ++d) {
+    if (finfo->stripe_fd[d] != -1) close(finfo->stripe_fd[d]);
+    finfo->stripe_fd[d] = -1;
+  }
+  finfo->fd = -1;
+}
+
 /* ------------------------------------------------------------
 * open files
 * ------------------------------------------------------------ */
@@ -436,7 +815,7 @@ void open_files_new(struct dumpfiles_t *DF) {
   int k;
   for (k=0; k<DF->num_files; k++) {
     struct file_info_t *finfo = &DF->file_info_list[k];
-    finfo->fd = open(finfo->fname, O_RDWR|O_CREAT|O_TRUNC, S_IREAD|S_IWRITE);
+    open_file_info(finfo, O_RDWR|O_CREAT|O_TRUNC);
 #if 0
     printf("file openned(new) [%s]\n",finfo->fname);
 #endif
@@ -450,7 +829,7 @@ void open_files(struct dumpfiles_t *DF) {
   int k;
   for (k=0; k<DF->num_files; k++) {
     struct file_info_t *finfo = &DF->file_info_list[k];
-    finfo->fd = open(finfo->fname, O_RDWR);
+    open_file_info(finfo, O_RDWR);
 #if 0
     printf("file openned(read/write mode) [%s]\n",finfo->fname);
 #endif
@@ -464,7 +843,7 @@ void open_files_readmode(struct dumpfiles_t *DF) {
   int k;
   for (k=0; k<DF->num_files; k++) {
     struct file_info_t *finfo = &DF->file_info_list[k];
-    finfo->fd = open(finfo->fname, O_RDONLY);
+    open_file_info(finfo, O_RDONLY);
 #if 0
 printf("file openned(read only mode) [%s]\n",finfo->fname);
 #endif
@@ -479,11 +858,11 @@ void open_files_direct(struct dumpfiles_t *DF) {
   for (k=0; k<DF->num_files; k++) {
     struct file_info_t *finfo = &DF->file_info_list[k];
 #ifdef O_DIRECT
-    finfo->fd = open(finfo->fname, O_RDWR|O_CREAT|O_TRUNC|O_DIRECT, S_IREAD|S_IWRITE);
+    open_file_info(finfo, O_RDWR|O_CREAT|O_TRUNC|O_DIRECT);
 #else
 #warning O_DIRECT is not define
     printf("open a file NOT O_DIRECT mode [%s]\n", finfo->fname);
-    finfo->fd = open(finfo->fname, O_RDWR|O_CREAT|O_TRUNC, S_IREAD|S_IWRITE);
+    open_file_info(finfo, O_RDWR|O_CREAT|O_TRUNC);
 #endif
 #if 0
 printf("file openned [%s]\n",finfo->fname);
@@ -499,11 +878,11 @@ void open_files_direct_readmode(struct dumpfiles_t *DF) {
   for (k=0; k<DF->num_files; k++) {
     struct file_info_t *finfo = &DF->file_info_list[k];
 #ifdef O_DIRECT
-    finfo->fd = open(finfo->fname, O_RDONLY|O_DIRECT);
+    open_file_info(finfo, O_RDONLY|O_DIRECT);
 #else
 #warning O_DIRECT is not define
     printf("open a file NOT O_DIRECT mode [%s]\n", finfo->fname);
-    finfo->fd = open(finfo->fname, O_RDONLY);
+    open_file_info(finfo, O_RDONLY);
 #endif
 #if 0
 printf("file openned [%s]\n",finfo->fname);
@@ -548,7 +927,7 @@ assert(finfo->fp);
 void close_files(struct dumpfiles_t *DF) {
   int k;
   for (k=0; k<DF->num_files; k++) {
-    close(DF->file_info_list[k].fd);
+    close_file_info(&DF->file_info_list[k]);
   }
 }
 
@@ -633,6 +1012,520 @@ void write_large_size(int fd, const void *buf, size_t size)
 }
 
 
+/* ------------------------------------------------------------
+* positional read/write through the (striped) file layout
+* ------------------------------------------------------------ */
+// a logical offset pos of a striped file is on
+//   device : (stripe_first + pos / STRIPE_SIZE) % num_stripes
+//   offset : (pos / STRIPE_SIZE / num_stripes) * STRIPE_SIZE + pos % STRIPE_SIZE
+// returns the fd holding the logical offset pos, and sets the physical offset
+// and the contiguous length (at most n) there
+static int map_file_offset(const struct file_info_t *finfo, size_t pos, size_t *off, size_t *n)
+{
+  if (finfo->num_stripes == 0) {
+    *off = pos;
+    return finfo->fd;
+  }
+  const size_t i = pos / STRIPE_SIZE, within = pos % STRIPE_SIZE;
+  *off = (i / finfo->num_stripes) * STRIPE_SIZE + within;
+  *n   = MIN(*n, STRIPE_SIZE - within);
+  return finfo->stripe_fd[(finfo->stripe_first + i) % finfo->num_stripes];
+}
+
+static size_t io_file_backing(const struct file_info_t *finfo, void *buf, size_t len, size_t pos, int is_write,
+                              long *syscalls)
+{
+  if (finfo->farmem && !is_write) {
+    if (pos >= finfo->farmem_size) return 0;
+    len = MIN(len, finfo->farmem_size - pos);
+    memcpy(buf, &finfo->farmem[pos], len);
+    return len;
+  }
+  size_t done = 0;
+  while (done < len) {
+    size_t off, n = MIN(len - done, SMALL_IO_BLOCK_SIZE);
+    const int fd = map_file_offset(finfo, pos + done, &off, &n);
+    ssize_t r = (is_write) ? pwrite(fd, (unsigned char *)buf + done, n, off)
+                           : pread(fd, (unsigned char *)buf + done, n, off);
+    ++*syscalls;
+    if (r <= 0) break;
+    done += r;
+  }
+  return done;
+}
+
+static size_t io_file(const struct file_info_t *finfo, void *buf, size_t len, size_t pos, int is_write)
+{
+#if PROFILE_IO == 1
+  const double t1 = monotonic_seconds();
+#endif
+#if NVM_EMULATION == 1
+  struct nvm_request_t R;
+  begin_nvm_request(finfo, len, &R);
+#endif
+  long syscalls = 0;
+  const size_t done = io_file_backing(finfo, buf, len, pos, is_write, &syscalls);
+#if NVM_EMULATION == 1
+  end_nvm_request(&R);
+#endif
+#if PROFILE_IO == 1
+  record_io_request(len, monotonic_seconds() - t1, syscalls);
+#endif
+  return done;
+}
+
+static size_t pread_compressed(const struct file_info_t *finfo, void *buf, size_t len, size_t pos);
+
+size_t pread_file(const struct file_info_t *finfo, void *buf, size_t len, size_t pos)
+{
+  if (finfo->cindex) {
+    return pread_compressed(finfo, buf, len, pos);
+  }
+  return io_file(finfo, buf, len, pos, 0);
+}
+
+size_t pwrite_file(const struct file_info_t *finfo, const void *buf, size_t len, size_t pos)
+{
+  assert( finfo->cindex == NULL );
+  return io_file(finfo, (void *)buf, len, pos, 1);
+}
+
+// starts read-ahead of the logical range [pos, pos+len) into the page cache
+void prefetch_file(const struct file_info_t *finfo, size_t len, size_t pos)
+{
+  if (finfo->farmem) return ;
+  if (finfo->cindex) {
+    const struct compress_index_t *CI = finfo->cindex;
+    const I64_t e0 = pos / sizeof(I64_t);
+    const I64_t e1 = MIN(CI->num_edges, (I64_t)((pos + len + sizeof(I64_t) - 1) / sizeof(I64_t)));
+    if (e0 >= e1) return ;
+    pos = CI->block_pos[e0 / COMPRESS_BLOCK_EDGES];
+    len = CI->block_pos[(e1 - 1) / COMPRESS_BLOCK_EDGES + 1] - pos;
+  }
+  size_t done = 0;
+  while (done < len) {
+    size_t off, n = len - done;
+    const int fd = map_file_offset(finfo, pos + done, &off, &n);
+    posix_fadvise(fd, off, n, POSIX_FADV_WILLNEED);
+#if PROFILE_IO == 1
+    if (io_stat) __sync_fetch_and_add(&io_stat->syscalls, 1);
+#endif
+    done += n;
+  }
+}
+
+size_t size_file(const struct file_info_t *finfo)
+{
+  struct stat sb;
+  size_t sz = 0;
+  if (finfo->num_stripes == 0) {
+    assert(fstat(finfo->fd, &sb) == 0);
+    return sb.st_size;
+  }
+  for (int d = 0; d < finfo->num_stripes; ++d) {
+    assert(fstat(finfo->stripe_fd[d], &sb) == 0);
+    sz += sb.st_size;
+  }
+  return sz;
+}
+
+
+/* ------------------------------------------------------------
+* block-compressed end file
+* ------------------------------------------------------------ */
+#define ZIGZAG_ENCODE(d) ( ((UL_t)(d) << 1) ^ (UL_t)((d) >> 63) )
+#define ZIGZAG_DECODE(z) ( (I64_t)((z) >> 1) ^ -(I64_t)((z) & 1) )
+
+// returns #words of the encoded block
+static I64_t encode_block(const I64_t *src, I64_t cnt, UL_t *dst)
+{
+  UL_t z, max_z = 0;
+  I64_t i;
+  for (i = 1; i < cnt; ++i) {
+    max_z |= ZIGZAG_ENCODE(src[i] - src[i-1]);
+  }
+  const int bits = (max_z) ? 64 - __builtin_clzll(max_z) : 0;
+  const I64_t words = ((cnt-1) * bits + 63) / 64;
+
+  dst[0] = (UL_t)src[0];
+  dst[1] = (UL_t)bits | ((UL_t)cnt << 8);
+  memset(&dst[2], 0x00, words * sizeof(UL_t));
+  for (i = 1; i < cnt; ++i) {
+    const size_t bitpos = (size_t)(i-1) * bits;
+    const size_t w = bitpos >> 6, o = bitpos & 63;
+    z = ZIGZAG_ENCODE(src[i] - src[i-1]);
+    dst[2+w] |= z << o;
+    if (o + bits > 64) dst[2+w+1] |= z >> (64 - o);
+  }
+  return 2 + words;
+}
+
+// returns #edges of the block
+static I64_t decode_block(const UL_t *src, I64_t *dst)
+{
+  const int bits = (int)(src[1] & 0xff);
+  const I64_t cnt = (I64_t)(src[1] >> 8);
+  const UL_t mask = (bits == 64) ? ~0ULL : (1ULL << bits) - 1;
+  const UL_t *p = &src[2];
+  I64_t i;
+
+  dst[0] = (I64_t)src[0];
+  if (bits == 0) {
+    for (i = 1; i < cnt; ++i) dst[i] = dst[0];
+    return cnt;
+  }
+  for (i = 1; i < cnt; ++i) {
+    const size_t bitpos = (size_t)(i-1) * bits;
+    const size_t w = bitpos >> 6, o = bitpos & 63;
+    UL_t z = p[w] >> o;
+    if (o + bits > 64) z |= p[w+1] << (64 - o);
+    z &= mask;
+    dst[i] = dst[i-1] + ZIGZAG_DECODE(z);
+  }
+  return cnt;
+}
+
+// reads the logical range [pos, pos+len) of the uncompressed end file
+static size_t pread_compressed(const struct file_info_t *finfo, void *buf, size_t len, size_t pos)
+{
+  const struct compress_index_t *CI = finfo->cindex;
+  const I64_t B = COMPRESS_BLOCK_EDGES;
+  UL_t raw[COMPRESS_READ_LENGTH / sizeof(UL_t)];
+  I64_t dec[COMPRESS_BLOCK_EDGES];
+  I64_t *out = (I64_t *)buf;
+
+  assert( pos % sizeof(I64_t) == 0 && len % sizeof(I64_t) == 0 );
+  I64_t e = pos / sizeof(I64_t);
+  const I64_t e1 = MIN(CI->num_edges, (I64_t)((pos + len) / sizeof(I64_t)));
+
+  while (e < e1) {
+    // -- a run of blocks [b, bl) read by a single request -- //
+    I64_t b = e / B, bl = b + 1;
+    while (bl * B < e1 &&
+           CI->block_pos[bl+1] - CI->block_pos[b] <= (I64_t)COMPRESS_READ_LENGTH) {
+      ++bl;
+    }
+    const size_t bytes = CI->block_pos[bl] - CI->block_pos[b];
+    if (io_file(finfo, raw, bytes, CI->block_pos[b], 0) != bytes) break;
+
+    const UL_t *p = raw;
+    for (; b < bl; ++b) {
+      const I64_t cnt = decode_block(p, dec);
+      const I64_t lo = e - b * B;
+      const I64_t hi = MIN(e1 - b * B, cnt);
+      memcpy(out, &dec[lo], (hi - lo) * sizeof(I64_t));
+      out += hi - lo;
+      e   += hi - lo;
+      p   += (CI->block_pos[b+1] - CI->block_pos[b]) / sizeof(UL_t);
+    }
+  }
+  return (unsigned char *)out - (unsigned char *)buf;
+}
+
+/* ------------------------------------------------------------
+* compress_graph_end
+*   writes the block-compressed copy and the block index of the
+*   end file of each NUMA node. unless is_forced, it does nothing
+*   if all index files exist.
+* ------------------------------------------------------------ */
+void compress_graph_end(int is_forced)
+{
+  struct dumpfiles_t *DF_e = init_dumpfile_info_graph("", 0, 1);
+  struct dumpfiles_t *DF_c = init_dumpfile_info_graph(COMPRESS_SUFFIX_DATA, 0, 1);
+  struct dumpfiles_t *DF_i = init_dumpfile_info_graph(COMPRESS_SUFFIX_INDEX, 0, 1);
+  int k;
+
+  if (!is_forced) {
+    int is_found = 1;
+    open_files_readmode(DF_i);
+    for (k = 0; k < DF_i->num_files; ++k) {
+      if (DF_i->file_info_list[k].fd == -1) is_found = 0;
+    }
+    close_files(DF_i);
+    if (is_found) {
+      free_files(DF_e);
+      free_files(DF_c);
+      free_files(DF_i);
+      return ;
+    }
+  }
+
+  const double t1 = get_seconds();
+  open_files_readmode(DF_e);
+  open_files_new(DF_c);
+  open_files_new(DF_i);
+
+  const I64_t B = COMPRESS_BLOCK_EDGES;
+  const I64_t chunk_blocks = DUMP_BUF_LENGTH / COMPRESS_BLOCK_EDGES;
+  I64_t total_edges = 0, total_bytes = 0;
+
+  OMP("omp parallel for reduction(+:total_edges,total_bytes)")
+  for (k = 0; k < DF_e->num_files; ++k) {
+    const struct file_info_t *fi_e = &DF_e->file_info_list[k];
+    const struct file_info_t *fi_c = &DF_c->file_info_list[k];
+    const struct file_info_t *fi_i = &DF_i->file_info_list[k];
+    assert( fi_e->fd != -1 && fi_c->fd != -1 && fi_i->fd != -1 );
+
+    const I64_t m = size_file(fi_e) / sizeof(I64_t);
+    const I64_t num_blocks = (m + B - 1) / B;
+    I64_t *index = NULL, *in = NULL;
+    UL_t *out = NULL;
+    assert( index = (I64_t *)calloc(num_blocks + 3, sizeof(I64_t)) );
+    assert( in  = (I64_t *)malloc(chunk_blocks * B * sizeof(I64_t)) );
+    assert( out = (UL_t *)malloc(chunk_blocks * (B + 1) * sizeof(UL_t)) );
+    I64_t *block_pos = &index[2];
+    index[0] = m;
+    index[1] = num_blocks;
+
+    I64_t b = 0, pos_c = 0;
+    for (I64_t e = 0; e < m; e += chunk_blocks * B) {
+      const I64_t len = MIN(m - e, chunk_blocks * B);
+      assert( pread_file(fi_e, in, len * sizeof(I64_t), e * sizeof(I64_t)) == len * sizeof(I64_t) );
+      I64_t words = 0;
+      for (I64_t j = 0; j < len; j += B, ++b) {
+        block_pos[b] = pos_c + words * sizeof(UL_t);
+        words += encode_block(&in[j], MIN(len - j, B), &out[words]);
+      }
+      assert( pwrite_file(fi_c, out, words * sizeof(UL_t), pos_c) == words * sizeof(UL_t) );
+      pos_c += words * sizeof(UL_t);
+    }
+    block_pos[num_blocks] = pos_c;
+    assert( pwrite_file(fi_i, index, (num_blocks + 3) * sizeof(I64_t), 0) == (num_blocks + 3) * sizeof(I64_t) );
+
+    total_edges += m;
+    total_bytes += pos_c;
+    free(index);
+    free(in);
+    free(out);
+  }
+
+  for (k = 0; k < DF_c->num_files; ++k) {
+    drop_pagecache_file_info(&DF_c->file_info_list[k]);
+  }
+  close_files(DF_e);
+  close_files(DF_c);
+  close_files(DF_i);
+  free_files(DF_e);
+  free_files(DF_c);
+  free_files(DF_i);
+
+  printf("compressed end files: %lld edges, %.2f bytes/edge (%.2fx) takes %.3f seconds\n",
+         total_edges, (double)total_bytes / MAX(total_edges, 1),
+         (double)total_edges * sizeof(I64_t) / MAX(total_bytes, 1), get_seconds() - t1);
+}
+
+/* ------------------------------------------------------------
+* init_dumpfile_info_graph_compressed
+*   file info of the compressed end files with their block indices
+* ------------------------------------------------------------ */
+struct dumpfiles_t *init_dumpfile_info_graph_compressed(int is_single_thrd)
+{
+  struct dumpfiles_t *DF = init_dumpfile_info_graph(COMPRESS_SUFFIX_DATA, 0, is_single_thrd);
+  struct dumpfiles_t *DF_i = init_dumpfile_info_graph(COMPRESS_SUFFIX_INDEX, 0, 1);
+  open_files_readmode(DF_i);
+
+  assert( DF_i->num_files > 0 );
+  DF->num_cindex = DF_i->num_files;
+  assert( DF->cindex_list = (struct compress_index_t *)calloc((size_t)DF->num_cindex, sizeof(struct compress_index_t)) );
+  for (int k = 0; k < DF->num_cindex; ++k) {
+    const struct file_info_t *fi_i = &DF_i->file_info_list[k];
+    struct compress_index_t *CI = &DF->cindex_list[k];
+    I64_t header[2];
+    if ( fi_i->fd == -1 || pread_file(fi_i, header, sizeof(header), 0) != sizeof(header) ) {
+      fprintf(stderr, "[error] can not read compressed index %s\n", fi_i->fname);
+      exit(EXIT_FAILURE);
+    }
+    CI->num_edges  = header[0];
+    CI->num_blocks = header[1];
+    assert( CI->block_pos = (I64_t *)malloc((CI->num_blocks + 1) * sizeof(I64_t)) );
+    assert( pread_file(fi_i, CI->block_pos, (CI->num_blocks + 1) * sizeof(I64_t), sizeof(header))
+            == (CI->num_blocks + 1) * sizeof(I64_t) );
+  }
+  close_files(DF_i);
+  free_files(DF_i);
+
+  for (int k = 0; k < DF->num_files; ++k) {
+    const int nodeid = (is_single_thrd) ? k : get_numa_nodeid(k);
+    DF->file_info_list[k].cindex = &DF->cindex_list[nodeid];
+  }
+  return DF;
+}
+
+
+/* ------------------------------------------------------------
+* load_files_farmem
+*   copies each file of DF to memory bound to the far-memory NUMA
+*   node. the entries of the same file (one for each thread) share
+*   the copy, which is unmapped by free_files.
+* ------------------------------------------------------------ */
+void load_files_farmem(struct dumpfiles_t *DF, int farmem_nodeid)
+{
+  const double t1 = get_seconds();
+  size_t total = 0;
+  int k, o;
+  if (farmem_nodeid < 0 || farmem_nodeid >= (int)(sizeof(unsigned long)*8)) {
+    fprintf(stderr, "[error] invalid far-memory node %d\n", farmem_nodeid);
+    exit(EXIT_FAILURE);
+  }
+
+  for (k = 0; k < DF->num_files; ++k) {
+    struct file_info_t *finfo = &DF->file_info_list[k];
+    for (o = 0; o < k; ++o) {
+      if ( !strcmp(DF->file_info_list[o].fname, finfo->fname) ) break;
+    }
+    if (o < k) {
+      finfo->farmem      = DF->file_info_list[o].farmem;
+      finfo->farmem_size = DF->file_info_list[o].farmem_size;
+      finfo->emu_dev     = DF->file_info_list[o].emu_dev;
+      continue;
+    }
+
+    assert( finfo->fd != -1 );
+    const size_t sz = size_file(finfo);
+    const size_t memsize = ROUNDUP(MAX(sz, 1), DIRECT_IO_BLOCK_SIZE);
+    unsigned char *p = (unsigned char *)mmap(NULL, memsize, PROT_READ|PROT_WRITE,
+                                             MAP_PRIVATE|MAP_ANONYMOUS, -1, 0);
+    assert( p != MAP_FAILED );
+    unsigned long mask = 1UL << farmem_nodeid;
+    if ( mbind(p, memsize, MPOL_BIND, &mask, sizeof(unsigned long)*8, 0) != 0 ) {
+      fprintf(stderr, "[error] can not bind %s to far-memory node %d\n", finfo->fname, farmem_nodeid);
+      exit(EXIT_FAILURE);
+    }
+    // whole blocks, so that files opened with O_DIRECT can be read
+    assert( io_file(finfo, p, memsize, 0, 0) == sz );
+    finfo->farmem          = p;
+    finfo->farmem_size     = sz;
+    finfo->is_farmem_owner = 1;
+#if NVM_EMULATION == 1
+    finfo->emu_dev = nvm_device("far memory");
+#endif
+    total += sz;
+  }
+  printf("far memory (node %d): %.2f GB loaded takes %.3f seconds\n",
+         farmem_nodeid, (double)total / (1ULL<<30), get_seconds() - t1);
+}
+
+
+/* ------------------------------------------------------------
+* I/O worker threads
+* ------------------------------------------------------------ */
+static void *io_worker(void *arg)
+{
+  struct io_queue_t *Q = (struct io_queue_t *)arg;
+
+  /* bind to the cores of the NUMA node */
+  cpu_set_t mask;
+  CPU_ZERO(&mask);
+  for (int u = 0; u < get_numa_num_threads(); ++u) {
+    if ( get_numa_nodeid(u) == Q->nodeid ) {
+      CPU_SET(get_numa_procid(u), &mask);
+    }
+  }
+  if ( CPU_COUNT(&mask) > 0 ) {
+    assert( !sched_setaffinity((pid_t)0, sizeof(cpu_set_t), &mask) );
+  }
+  is_io_worker = 1;
+
+  pthread_mutex_lock(&Q->lock);
+  for (;;) {
+    while ( !Q->head && !Q->is_shutdown ) {
+      pthread_cond_wait(&Q->posted, &Q->lock);
+    }
+    struct io_job_t *job = Q->head;
+    if ( !job ) break;
+    Q->head = job->next;
+    if ( !Q->head ) Q->tail = NULL;
+    pthread_mutex_unlock(&Q->lock);
+
+    io_stat = job->stat;
+    job->func(job);
+    io_stat = NULL;
+
+    pthread_mutex_lock(&Q->lock);
+    job->done = 1;
+    pthread_cond_broadcast(&Q->completed);
+  }
+  pthread_mutex_unlock(&Q->lock);
+  return NULL;
+}
+
+struct io_workers_t *start_io_workers(int num_queues, int threads_per_queue)
+{
+  struct io_workers_t *W = NULL;
+  assert( W = (struct io_workers_t *)calloc(1, sizeof(struct io_workers_t)) );
+  assert( W->queues = (struct io_queue_t *)calloc(num_queues, sizeof(struct io_queue_t)) );
+  W->num_queues = num_queues;
+
+  if (threads_per_queue < 1) threads_per_queue = 1;
+  for (int k = 0; k < num_queues; ++k) {
+    struct io_queue_t *Q = &W->queues[k];
+    pthread_mutex_init(&Q->lock, NULL);
+    pthread_cond_init(&Q->posted, NULL);
+    pthread_cond_init(&Q->completed, NULL);
+    Q->nodeid = k;
+    Q->num_workers = threads_per_queue;
+    assert( Q->workers = (pthread_t *)calloc(Q->num_workers, sizeof(pthread_t)) );
+    for (int t = 0; t < Q->num_workers; ++t) {
+      assert( !pthread_create(&Q->workers[t], NULL, io_worker, Q) );
+    }
+  }
+  return W;
+}
+
+void post_io_job(struct io_workers_t *W, int queue_no, struct io_job_t *job)
+{
+  struct io_queue_t *Q = &W->queues[queue_no % W->num_queues];
+  job->done  = 0;
+  job->queue = Q;
+  job->next  = NULL;
+  job->stat  = io_stat;
+
+  pthread_mutex_lock(&Q->lock);
+  if ( Q->tail ) Q->tail->next = job;
+  else           Q->head = job;
+  Q->tail = job;
+  pthread_cond_signal(&Q->posted);
+  pthread_mutex_unlock(&Q->lock);
+}
+
+void wait_io_job(struct io_job_t *job)
+{
+  struct io_queue_t *Q = job->queue;
+#if PROFILE_IO == 1
+  const double t1 = monotonic_seconds();
+#endif
+  pthread_mutex_lock(&Q->lock);
+  while ( !job->done ) {
+    pthread_cond_wait(&Q->completed, &Q->lock);
+  }
+  pthread_mutex_unlock(&Q->lock);
+#if PROFILE_IO == 1
+  if (io_stat) __sync_fetch_and_add(&io_stat->blocked_nsec, (long)((monotonic_seconds() - t1) * 1e9));
+#endif
+}
+
+void stop_io_workers(struct io_workers_t *W)
+{
+  if ( !W ) return;
+  for (int k = 0; k < W->num_queues; ++k) {
+    struct io_queue_t *Q = &W->queues[k];
+    pthread_mutex_lock(&Q->lock);
+    Q->is_shutdown = 1;
+    pthread_cond_broadcast(&Q->posted);
+    pthread_mutex_unlock(&Q->lock);
+    for (int t = 0; t < Q->num_workers; ++t) {
+      pthread_join(Q->workers[t], NULL);
+    }
+    pthread_cond_destroy(&Q->posted);
+    pthread_cond_destroy(&Q->completed);
+    pthread_mutex_destroy(&Q->lock);
+    free(Q->workers);
+  }
+  free(W->queues);
+  free(W);
+}
+
+
 /* ------------------------------------------------------------
 * dump edgelist by fwrite
 * ------------------------------------------------------------ */
@@ -796,33 +1689,29 @@ void dump_subgraph_mergingmode(struct subgraph_t *subgraph,
   }
   close(fd_s);
 
-// dump "end" data
-    char *fname_e = CALLOCA(MAX_FNAME);
-  sprintf(fname_e,
-    "%.128s_BG_end_SCALE%d_%d_%.128s",
-    fname_base_list.fname_bases[target_no % fname_base_list.num_fname_bases],
-    SCALE,
-    target_no,
-    "");
-  int fd_e;
+// dump "end" data (striped over devices if STRIPE_GRAPH_END)
+  struct dumpfiles_t *DF_e = init_dumpfile_info_graph("", 0, 1);
+  struct file_info_t *finfo_e = &DF_e->file_info_list[target_no];
   if (subgraph_no % lgraphs == 0) {
-    fd_e = open(fname_e, O_RDWR|O_CREAT|O_TRUNC, S_IREAD|S_IWRITE);
+    open_file_info(finfo_e, O_RDWR|O_CREAT|O_TRUNC);
   } else {
-    fd_e = open(fname_e, O_RDWR);
+    open_file_info(finfo_e, O_RDWR);
   }
-  if (fd_e != -1) {
-    lseek(fd_e, 0, SEEK_END);
-    write_large_size(fd_e,
+  if (finfo_e->fd != -1) {
+    const size_t written_length = pwrite_file(finfo_e,
      subgraph->end,
-     sizeof(I64_t)*subgraph->m);
-    printf(" end = %s;", fname_e);
+     sizeof(I64_t)*subgraph->m,
+     size_file(finfo_e));
+    assert(written_length == sizeof(I64_t)*subgraph->m);
+    printf(" end = %s;", finfo_e->fname);
   }
 #if 0
   for(I64_t k = 0; k < subgraph->m; k++) {
     fprintf(stderr, "%lld\n", subgraph->end[k]);
   }
 #endif
-  close(fd_e);
+  close_file_info(finfo_e);
+  free_files(DF_e);
   printf("}\n");
 }
 
@@ -884,6 +1773,14 @@ void free_subgraph(struct mempool_t *mempool_list, int num_graphs) {
 /* ------------------------------------------------------------
 *  drop page caches
 * ------------------------------------------------------------ */
+void drop_pagecache_file_info(struct file_info_t *finfo)
+{
+  drop_pagecache_file(finfo->fname);
+  for (int d = 0; d < finfo->num_stripes; ++d) {
+    drop_pagecache_file(finfo->stripe_fname[d]);
+  }
+}
+
 void drop_pagecache_file(char *fname)
 {
 
@@ -1021,6 +1918,525 @@ void erasure_pool_file(struct mempool_t *pool, int fd, char *fname)
 }
 
 
+/* ------------------------------------------------------------
+*  profile-guided placement of external edges
+* ------------------------------------------------------------ */
+void dump_placement_profile(I64_t **exmem_access, struct graph_t *G)
+{
+  struct dumpfiles_t *DF = init_dumpfile_info_placement("");
+  open_files_new(DF);
+
+  printf("dump placement profile in {\n");
+  for (int k = 0; k < G->num_graphs; ++k) {
+    assert(DF->file_info_list[k].fd >= 0);
+    write_large_size(DF->file_info_list[k].fd, exmem_access[k], G->BG_list[k].n * sizeof(I64_t));
+    printf(" %d : [ %s ]\n", k, DF->file_info_list[k].fname);
+  }
+  printf("}\n");
+
+  close_files(DF);
+  free_files(DF);
+}
+
+
+struct placement_cand_t {
+  I64_t v;
+  I64_t tail;
+  I64_t access;
+};
+
+/* descending order of #exmem-edge-reads per promoted edge */
+static int placement_cand_cmp(const void *a, const void *b) {
+  const struct placement_cand_t *_a = (const struct placement_cand_t *)a;
+  const struct placement_cand_t *_b = (const struct placement_cand_t *)b;
+  const double _da = (double)_a->access / _a->tail;
+  const double _db = (double)_b->access / _b->tail;
+  if (_da > _db) return -1;
+  if (_da < _db) return  1;
+  if (_a->v < _b->v) return -1;
+  if (_a->v > _b->v) return  1;
+  return 0;
+}
+
+struct placement_map_t *load_placement_map(I64_t num_nodes, int num_lists)
+{
+  const I64_t chunk = ROUNDUP(num_nodes/num_lists, 64);
+  const I64_t budget_env = getenvi((char *)ENV_PLACEMENT_BUDGET, -1);
+
+  struct dumpfiles_t *DF_s = init_dumpfile_info_graph("", 1, 1);
+  struct dumpfiles_t *DF_p = init_dumpfile_info_placement("");
+  open_files_readmode(DF_s);
+  open_files_readmode(DF_p);
+  for (int k = 0; k < num_lists; ++k) {
+    if (DF_p->file_info_list[k].fd < 0) {
+      fprintf(stderr, "[error] placement profile [ %s ] is not found\n",
+              DF_p->file_info_list[k].fname);
+      exit(1);
+    }
+  }
+
+  struct placement_map_t *PM = NULL;
+  assert( PM = (struct placement_map_t *)calloc(1, sizeof(struct placement_map_t)) );
+  PM->num_maps = num_lists;
+  assert( PM->promoted = (unsigned long **)calloc(num_lists, sizeof(unsigned long *)) );
+  assert( PM->promoted_edges = (I64_t *)calloc(num_lists, sizeof(I64_t)) );
+  I64_t *budget = (I64_t *)CALLOCA(num_lists * sizeof(I64_t));
+  I64_t *num_promoted = (I64_t *)CALLOCA(num_lists * sizeof(I64_t));
+
+  const double t1 = get_seconds();
+  OMP("omp parallel num_threads(get_numa_num_threads())") {
+    int id = omp_get_thread_num();
+    int nodeid = get_numa_nodeid(id);
+    int coreid = get_numa_vircoreid(id);
+    pinned(USE_HYBRID_AFFINITY, id);
+    OMP("omp barrier");
+
+    if (coreid == 0) {
+      const I64_t range = MIN(chunk, num_nodes - chunk * nodeid);
+      I64_t j, c = 0, *start = NULL, *access = NULL;
+      struct placement_cand_t *cand = NULL;
+      assert( start  = (I64_t *)malloc((range+1) * sizeof(I64_t)) );
+      assert( access = (I64_t *)malloc(range * sizeof(I64_t)) );
+      assert( PM->promoted[nodeid] = (unsigned long *)calloc(BIT_i(range)+1, sizeof(unsigned long)) );
+      read_large_size(DF_s->file_info_list[nodeid].fd, start, (range+1) * sizeof(I64_t));
+      read_large_size(DF_p->file_info_list[nodeid].fd, access, range * sizeof(I64_t));
+
+      /* same DRAM budget as the positional baseline rule */
+      budget[nodeid] = 0;
+      for (j = 0; j < range; ++j) {
+        const I64_t dg = start[j+1] - start[j];
+        if (dg > max_onmem_edges) {
+          if (dg >= baseline_fully_onmem_edges) budget[nodeid] += dg - max_onmem_edges;
+          if (access[j] > 0) ++c;
+        }
+      }
+      if (budget_env >= 0) budget[nodeid] = budget_env;
+
+      assert( cand = (struct placement_cand_t *)malloc((c+1) * sizeof(struct placement_cand_t)) );
+      c = 0;
+      for (j = 0; j < range; ++j) {
+        const I64_t dg = start[j+1] - start[j];
+        if (dg > max_onmem_edges && access[j] > 0) {
+          cand[c].v      = j;
+          cand[c].tail   = dg - max_onmem_edges;
+          cand[c].access = access[j];
+          ++c;
+        }
+      }
+      qsort(cand, c, sizeof(struct placement_cand_t), placement_cand_cmp);
+
+      I64_t rest = budget[nodeid];
+      for (j = 0; j < c; ++j) {
+        if (cand[j].tail <= rest) {
+          SET_BITMAP(PM->promoted[nodeid], cand[j].v);
+          rest -= cand[j].tail;
+          ++num_promoted[nodeid];
+        }
+      }
+      PM->promoted_edges[nodeid] = budget[nodeid] - rest;
+
+      free(cand);
+      free(access);
+      free(start);
+    }
+    clear_affinity();
+  }
+  const double t2 = get_seconds();
+
+  for (int k = 0; k < num_lists; ++k) {
+    printf("[node%02d] placement map: promoted %lld vertices, %lld / %lld tail edges on DRAM\n",
+           k, num_promoted[k], PM->promoted_edges[k], budget[k]);
+  }
+  printf("load placement map takes %.3f seconds\n", t2-t1);
+
+  close_files(DF_s);
+  close_files(DF_p);
+  free_files(DF_s);
+  free_files(DF_p);
+
+  return PM;
+}
+
+void free_placement_map(struct placement_map_t *PM)
+{
+  if (!PM) return ;
+  for (int k = 0; k < PM->num_maps; ++k) {
+    free(PM->promoted[k]);
+  }
+  free(PM->promoted);
+  free(PM->promoted_edges);
+  free(PM);
+}
+
+// #edges of vertex j (node-local ID) kept on DRAM
+// without placement map, the positional rule (-m, -f) is used.
+I64_t get_onmem_degree(const struct placement_map_t *PM, int nodeid, I64_t j, I64_t dg)
+{
+  if (dg <= max_onmem_edges) {
+    return dg;
+  }
+  if (PM) {
+    return ISSET_BITMAP(PM->promoted[nodeid], j) ? dg : max_onmem_edges;
+  }
+  return (dg >= baseline_fully_onmem_edges) ? dg : max_onmem_edges;
+}
+
+
+/* ------------------------------------------------------------
+* bulk loading of the on-DRAM graph
+* ------------------------------------------------------------ */
+static void read_start_block(const struct file_info_t *fi_s, I64_t *buf, I64_t j, I64_t n)
+{
+  const size_t len = n * sizeof(I64_t);
+  if (pread_file(fi_s, buf, len, j * sizeof(I64_t)) != len) {
+    fprintf(stderr, "[error] read_start_block: %s, j=%lld, n=%lld\n", fi_s->fname, j, n);
+    exit(1);
+  }
+}
+
+I64_t load_onmem_degrees(const struct file_info_t *fi_s, const struct placement_map_t *PM,
+                         int nodeid, I64_t ls, I64_t le, I64_t *degree)
+{
+  I64_t *buf = NULL;
+  assert( buf = (I64_t *)malloc((LOAD_START_BLOCK+1) * sizeof(I64_t)) );
+
+  I64_t sum = 0;
+  for (I64_t b = ls; b < le; b += LOAD_START_BLOCK) {
+    const I64_t n = MIN((I64_t)LOAD_START_BLOCK, le - b);
+    read_start_block(fi_s, buf, b, n+1);
+    for (I64_t i = 0; i < n; ++i) {
+      const I64_t onm = get_onmem_degree(PM, nodeid, b+i, buf[i+1] - buf[i]);
+      if (degree) degree[b+i-ls] = onm;
+      sum += onm;
+    }
+  }
+
+  free(buf);
+  return sum;
+}
+
+static void read_onmem_run(const struct file_info_t *fi_e, I64_t *dst, I64_t pos, I64_t len)
+{
+  if (len == 0) return ;
+  const size_t sz = len * sizeof(I64_t);
+  if (pread_file(fi_e, dst, sz, pos * sizeof(I64_t)) != sz) {
+    fprintf(stderr, "[error] read_onmem_run: %s, pos=%lld, len=%lld\n", fi_e->fname, pos, len);
+    exit(1);
+  }
+}
+
+void load_onmem_adjacency(const struct file_info_t *fi_s, const struct file_info_t *fi_e,
+                          const struct placement_map_t *PM, int nodeid, I64_t ls, I64_t le,
+                          const I64_t *start, I64_t *end)
+{
+  I64_t *buf = NULL;
+  assert( buf = (I64_t *)malloc((LOAD_START_BLOCK+1) * sizeof(I64_t)) );
+
+  I64_t run_pos = 0, run_dst = 0, run_len = 0;
+  for (I64_t b = ls; b < le; b += LOAD_START_BLOCK) {
+    const I64_t n = MIN((I64_t)LOAD_START_BLOCK, le - b);
+    read_start_block(fi_s, buf, b, n+1);
+    for (I64_t i = 0; i < n; ++i) {
+      const I64_t fs = buf[i];
+      const I64_t onm = get_onmem_degree(PM, nodeid, b+i, buf[i+1] - fs);
+      if (onm == 0) continue;
+      if (run_pos + run_len == fs && run_dst + run_len == start[b+i]) {
+        run_len += onm;
+      } else {
+        read_onmem_run(fi_e, &end[run_dst], run_pos, run_len);
+        run_pos = fs;
+        run_dst = start[b+i];
+        run_len = onm;
+      }
+    }
+  }
+  read_onmem_run(fi_e, &end[run_dst], run_pos, run_len);
+
+  free(buf);
+}
+
+
+/* ------------------------------------------------------------
+* tail signatures
+* ------------------------------------------------------------ */
+unsigned long *tail_sig[MAX_NODES];
+int tail_sig_shift = 0;
+
+void build_tail_signatures(struct graph_t *G)
+{
+  const double t1 = get_seconds();
+  struct dumpfiles_t *DF_s = init_dumpfile_info_graph("", 1, 0);
+  struct dumpfiles_t *DF_e = init_dumpfile_info_graph("", 0, 0);
+  open_files_readmode(DF_s);
+  open_files_readmode(DF_e);
+
+  // 64 blocks of vertex IDs, a block covers whole bitmap words
+  tail_sig_shift = MAX(64 - __builtin_clzll(G->n - 1) - 6, (int)UL_SHIFT2);
+  for (int k = 0; k < G->num_graphs; ++k) {
+    assert( tail_sig[k] = (unsigned long *)calloc(G->BG_list[k].n + 1, sizeof(unsigned long)) );
+  }
+  I64_t num_tails = 0, num_blocks = 0;
+
+  OMP("omp parallel num_threads(get_numa_num_threads()) reduction(+:num_tails,num_blocks)") {
+    int id = omp_get_thread_num();
+    int nodeid = get_numa_nodeid(id);
+    int coreid = get_numa_vircoreid(id);
+    int lcores = get_numa_online_cores(nodeid);
+    pinned(USE_HYBRID_AFFINITY, id);
+
+    struct subgraph_t *BG = &G->BG_list[nodeid];
+    const struct file_info_t *fi_s = &DF_s->file_info_list[id];
+    const struct file_info_t *fi_e = &DF_e->file_info_list[id];
+    unsigned long *sig = tail_sig[nodeid];
+    I64_t *fstart = NULL, *edges = NULL;
+    assert( fstart = (I64_t *)malloc((DUMP_BUF_LENGTH + 1) * sizeof(I64_t)) );
+    assert( edges  = (I64_t *)malloc(DUMP_BUF_LENGTH * sizeof(I64_t)) );
+
+    I64_t ls, le;
+    partial_range(BG->n, 0, lcores, coreid, &ls, &le);
+    for (I64_t j0 = ls; j0 < le; j0 += DUMP_BUF_LENGTH) {
+      const I64_t nv = MIN(le - j0, (I64_t)DUMP_BUF_LENGTH);
+      assert( pread_file(fi_s, fstart, (nv + 1) * sizeof(I64_t), j0 * sizeof(I64_t)) == (nv + 1) * sizeof(I64_t) );
+
+      for (I64_t j = j0; j < j0 + nv; ++j) {
+        const I64_t onm = BG->start[j+1] - BG->start[j];
+        if (onm < max_onmem_edges) continue;   // no external tail is read
+
+        I64_t pos = fstart[j-j0] + onm;
+        const I64_t fe = fstart[j-j0+1];
+        unsigned long mask = 0;
+        while (pos < fe) {
+          const I64_t len = MIN(fe - pos, (I64_t)DUMP_BUF_LENGTH);
+          assert( pread_file(fi_e, edges, len * sizeof(I64_t), pos * sizeof(I64_t)) == len * sizeof(I64_t) );
+          for (I64_t x = 0; x < len; ++x) {
+            mask |= TAIL_SIG_BLOCK(edges[x]);
+          }
+          pos += len;
+        }
+        sig[j] = mask;
+        ++num_tails;
+        num_blocks += __builtin_popcountl(mask);
+      }
+    }
+    free(fstart);
+    free(edges);
+    clear_affinity();
+  }
+
+  for (int k = 0; k < DF_e->num_files; ++k) {
+    drop_pagecache_file(DF_s->file_info_list[k].fname);
+    drop_pagecache_file_info(&DF_e->file_info_list[k]);
+  }
+  close_files(DF_s);
+  close_files(DF_e);
+  free_files(DF_s);
+  free_files(DF_e);
+
+  printf("tail signatures: %lld tails, %.2f blocks/tail (%lld vertices/block) takes %.3f seconds\n",
+         num_tails, (double)num_blocks / MAX(num_tails, 1), 1LL << tail_sig_shift, get_seconds() - t1);
+}
+
+void free_tail_signatures(struct graph_t *G)
+{
+  for (int k = 0; k < G->num_graphs; ++k) {
+    free(tail_sig[k]);
+    tail_sig[k] = NULL;
+  }
+}
+
+
+/* ------------------------------------------------------------
+* layout of external tails
+* ------------------------------------------------------------ */
+I64_t *tail_layout[MAX_NODES];
+
+/* hash of the DRAM degrees of the vertices that have an external tail */
+static I64_t tail_split_hash(const struct subgraph_t *BG)
+{
+  UL_t h = 14695981039346656037UL;
+  for (I64_t j = 0; j < BG->n; ++j) {
+    const I64_t onm = BG->start[j+1] - BG->start[j];
+    if (onm < max_onmem_edges) continue;
+    h = (h ^ (UL_t)j)   * 1099511628211UL;
+    h = (h ^ (UL_t)onm) * 1099511628211UL;
+  }
+  return (I64_t)h;
+}
+
+static void copy_tail(const struct file_info_t *fi_e, const struct file_info_t *fi_l,
+                      I64_t *buf, I64_t src, I64_t len, I64_t dst)
+{
+  for (I64_t e = 0; e < len; e += DUMP_BUF_LENGTH) {
+    const I64_t l = MIN(len - e, (I64_t)DUMP_BUF_LENGTH);
+    assert( pread_file(fi_e, buf, l * sizeof(I64_t), (src + e) * sizeof(I64_t)) == l * sizeof(I64_t) );
+    assert( pwrite_file(fi_l, buf, l * sizeof(I64_t), (dst + e) * sizeof(I64_t)) == l * sizeof(I64_t) );
+  }
+}
+
+/* writes the layout file of a node and sets layout[] and header[] */
+static void build_tail_layout(const struct subgraph_t *BG, const struct file_info_t *fi_s,
+                              const struct file_info_t *fi_e, const struct file_info_t *fi_l,
+                              I64_t *layout, I64_t *header)
+{
+  const I64_t n = BG->n;
+  const I64_t Bk = LAYOUT_BLOCK_EDGES;
+  I64_t *src = NULL, *len = NULL, *in = NULL, *out = NULL;
+  assert( src = (I64_t *)malloc((n + 1) * sizeof(I64_t)) );
+  assert( len = (I64_t *)malloc((n + 1) * sizeof(I64_t)) );
+  assert( in  = (I64_t *)malloc((DUMP_BUF_LENGTH + 1) * sizeof(I64_t)) );
+  assert( out = (I64_t *)malloc(DUMP_BUF_LENGTH * sizeof(I64_t)) );
+  I64_t j, pos, num_edges = 0;
+
+  // -- external tail of each vertex -- //
+  for (I64_t j0 = 0; j0 < n; j0 += DUMP_BUF_LENGTH) {
+    const I64_t nv = MIN(n - j0, (I64_t)DUMP_BUF_LENGTH);
+    assert( pread_file(fi_s, in, (nv + 1) * sizeof(I64_t), j0 * sizeof(I64_t)) == (nv + 1) * sizeof(I64_t) );
+    for (j = j0; j < j0 + nv; ++j) {
+      const I64_t onm = BG->start[j+1] - BG->start[j];
+      src[j] = in[j-j0] + onm;
+      len[j] = (onm < max_onmem_edges) ? 0 : MAX(in[j-j0+1] - src[j], 0);
+      num_edges += len[j];
+    }
+  }
+
+  // -- hot region: hub tails, each from a block boundary -- //
+  pos = 0;
+  for (j = 0; j < n; ++j) {
+    layout[j] = 0;
+    if (len[j] < Bk) continue;
+    layout[j] = pos;
+    pos = (I64_t)ROUNDUP(pos + len[j], Bk);
+  }
+  const I64_t hot_edges = pos;
+
+  // -- cold region: the other tails in vertex-ID order, none straddles a block -- //
+  for (j = 0; j < n; ++j) {
+    if (len[j] == 0 || len[j] >= Bk) continue;
+    if (pos % Bk + len[j] > Bk) pos = (I64_t)ROUNDUP(pos, Bk);
+    layout[j] = pos;
+    pos += len[j];
+  }
+
+  // -- copy: hub tails directly, the others through an input window and an output buffer -- //
+  const I64_t m_e = size_file(fi_e) / sizeof(I64_t);
+  I64_t in_pos = 0, in_len = 0, out_pos = hot_edges, out_len = 0;
+  for (j = 0; j < n; ++j) {
+    if (len[j] == 0) continue;
+    if (len[j] >= Bk) {
+      copy_tail(fi_e, fi_l, in, src[j], len[j], layout[j]);
+      in_len = 0;
+      continue;
+    }
+    if (src[j] + len[j] > in_pos + in_len) {
+      in_pos = src[j];
+      in_len = MIN(m_e - in_pos, (I64_t)DUMP_BUF_LENGTH);
+      assert( pread_file(fi_e, in, in_len * sizeof(I64_t), in_pos * sizeof(I64_t)) == in_len * sizeof(I64_t) );
+    }
+    if (layout[j] + len[j] - out_pos > (I64_t)DUMP_BUF_LENGTH) {
+      assert( pwrite_file(fi_l, out, out_len * sizeof(I64_t), out_pos * sizeof(I64_t)) == out_len * sizeof(I64_t) );
+      out_pos += out_len;
+      out_len = 0;
+    }
+    while (out_pos + out_len < layout[j]) out[out_len++] = 0;   // padding
+    memcpy(&out[out_len], &in[src[j] - in_pos], len[j] * sizeof(I64_t));
+    out_len += len[j];
+  }
+  if (out_len > 0) {
+    assert( pwrite_file(fi_l, out, out_len * sizeof(I64_t), out_pos * sizeof(I64_t)) == out_len * sizeof(I64_t) );
+  }
+
+  header[0] = n;
+  header[1] = tail_split_hash(BG);
+  header[2] = hot_edges;
+  header[3] = pos;
+  header[4] = num_edges;
+  free(src);
+  free(len);
+  free(in);
+  free(out);
+}
+
+/* ------------------------------------------------------------
+* layout_graph_tails
+*   loads the layout index of each NUMA node, or (re)writes the
+*   layout file and its index if is_forced, the index is missing,
+*   or it was written for another DRAM split.
+* ------------------------------------------------------------ */
+void layout_graph_tails(struct graph_t *G, int is_forced)
+{
+  const double t1 = get_seconds();
+  struct dumpfiles_t *DF_s = init_dumpfile_info_graph("", 1, 1);
+  struct dumpfiles_t *DF_e = init_dumpfile_info_graph("", 0, 1);
+  struct dumpfiles_t *DF_l = init_dumpfile_info_graph(LAYOUT_SUFFIX_DATA, 0, 1);
+  struct dumpfiles_t *DF_i = init_dumpfile_info_graph(LAYOUT_SUFFIX_INDEX, 0, 1);
+  I64_t num_built = 0, hot_edges = 0, layout_edges = 0, tail_edges = 0;
+  int k;
+
+  OMP("omp parallel for reduction(+:num_built,hot_edges,layout_edges,tail_edges)")
+  for (k = 0; k < G->num_graphs; ++k) {
+    const struct subgraph_t *BG = &G->BG_list[k];
+    struct file_info_t *fi_i = &DF_i->file_info_list[k];
+    I64_t header[5];
+    assert( tail_layout[k] = (I64_t *)malloc((BG->n + 1) * sizeof(I64_t)) );
+
+    // -- reuse the layout written for the same split -- //
+    if (!is_forced && open_file_info(fi_i, O_RDONLY) != -1) {
+      const int is_loaded =
+        pread_file(fi_i, header, sizeof(header), 0) == sizeof(header) &&
+        header[0] == BG->n && header[1] == tail_split_hash(BG) &&
+        pread_file(fi_i, tail_layout[k], BG->n * sizeof(I64_t), sizeof(header)) == BG->n * sizeof(I64_t);
+      close_file_info(fi_i);
+      if (is_loaded) {
+        hot_edges    += header[2];
+        layout_edges += header[3];
+        tail_edges   += header[4];
+        continue;
+      }
+    }
+
+    struct file_info_t *fi_s = &DF_s->file_info_list[k];
+    struct file_info_t *fi_e = &DF_e->file_info_list[k];
+    struct file_info_t *fi_l = &DF_l->file_info_list[k];
+    assert( open_file_info(fi_s, O_RDONLY) != -1 );
+    assert( open_file_info(fi_e, O_RDONLY) != -1 );
+    assert( open_file_info(fi_l, O_RDWR|O_CREAT|O_TRUNC) != -1 );
+    assert( open_file_info(fi_i, O_RDWR|O_CREAT|O_TRUNC) != -1 );
+
+    build_tail_layout(BG, fi_s, fi_e, fi_l, tail_layout[k], header);
+    assert( pwrite_file(fi_i, header, sizeof(header), 0) == sizeof(header) );
+    assert( pwrite_file(fi_i, tail_layout[k], BG->n * sizeof(I64_t), sizeof(header)) == BG->n * sizeof(I64_t) );
+
+    drop_pagecache_file(fi_s->fname);
+    drop_pagecache_file_info(fi_e);
+    drop_pagecache_file_info(fi_l);
+    close_file_info(fi_s);
+    close_file_info(fi_e);
+    close_file_info(fi_l);
+    close_file_info(fi_i);
+    ++num_built;
+    hot_edges    += header[2];
+    layout_edges += header[3];
+    tail_edges   += header[4];
+  }
+  free_files(DF_s);
+  free_files(DF_e);
+  free_files(DF_l);
+  free_files(DF_i);
+
+  printf("tail layout: %lld of %d nodes rebuilt, %lld tail edges, %.2f%% in hot region, %.2f%% padding takes %.3f seconds\n",
+         num_built, G->num_graphs, tail_edges, 100.0 * hot_edges / MAX(layout_edges, 1),
+         100.0 * (layout_edges - tail_edges) / MAX(layout_edges, 1), get_seconds() - t1);
+}
+
+void free_tail_layout(struct graph_t *G)
+{
+  for (int k = 0; k < G->num_graphs; ++k) {
+    free(tail_layout[k]);
+    tail_layout[k] = NULL;
+  }
+}
+
+
 /* ------------------------------------------------------------
 *  get proc info
 * ------------------------------------------------------------ */
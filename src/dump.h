@@ -20,6 +20,8 @@
 #ifndef DUMP_H
 #define DUMP_H
 
+#include <pthread.h>
+
 #include "ulibc.h"
 #include "mempol.h"
 #include "defs.h"
@@ -31,11 +33,58 @@
  * ----------------------------- */
 #define STORE_BFS_SOURCES             1
 #define STORE_GRAPH_IN_LOWMEM_MODE    0
-#define DUMP_BUF_LENGTH               (1ULL << 9)
-#define DUMP_BUF_READ_LENGTH_TD       (1ULL << 9)
-#define DUMP_BUF_READ_LENGTH_BU       (1ULL << 6)
+#define DUMP_BUF_LENGTH               (1ULL << 15)
+#define BUCKET_WRITE_BYTES            (1ULL << 22)  /* bucket staging of a construction thread, split over the buckets */
+#define BUCKET_WRITE_ALIGN            (1ULL << 12)  /* bucket flushes end at multiples of this in the file */
+#define STREAM_EDGE_BUCKETS           1             /* Kronecker generator writes edges straight into buckets */
+#define STREAM_CHUNK_EDGES            (1ULL << 14)  /* edges generated by a thread at a time */
+#define PIPELINE_CONSTRUCTION         1             /* overlap bucket I/O with building the next bucket */
+
+#define READ_LENGTH_PROBE             1             /* time the device at startup to seed the read lengths */
+#define READ_LENGTH_BU                (1ULL << 6)   /* first bottom-up read of a tail (#edges) if not probed */
+#define READ_LENGTH_MIN               (1ULL << 3)   /* #edges */
+#define READ_PROBE_ROUNDS             8             /* timed reads of each request size */
+#define ENV_READ_LENGTH_BU            "READ_LENGTH_BU"
+#define ENV_READ_LENGTH_MAX           "READ_LENGTH_MAX"
 
 #define DIRECT_IO_VALIDATION          0
+#define DIRECT_IO_BFS                 0
+#define DIRECT_IO_BLOCK_SIZE          (1ULL << 12)
+#define DIRECT_IO_WINDOW_SIZE         (1ULL << 16)
+
+#define IO_WORKER_BFS                 0             /* read exmem tails on I/O worker threads */
+#define IO_THREADS_PER_DEVICE         1
+#define IO_BATCHES_PER_THREAD         4             /* #in-flight batches of a BFS thread */
+#define ENV_IO_THREADS_PER_DEVICE     "IO_THREADS_PER_DEVICE"
+
+#define STRIPE_GRAPH_END              0             /* stripe _BG_end_ over all GRAPH paths */
+#define STRIPE_SIZE                   (1ULL << 20)  /* bytes */
+
+#define PREFETCH_NEXT_LEVEL           0             /* read-ahead next-level tails on I/O workers */
+
+#define COMPRESS_GRAPH_END            0             /* exmem BFS reads block-compressed _BG_end_ */
+#define COMPRESS_BLOCK_EDGES          (1ULL << 7)
+#define COMPRESS_READ_LENGTH          (1ULL << 16)  /* bytes */
+#define COMPRESS_SUFFIX_DATA          "cmp"
+#define COMPRESS_SUFFIX_INDEX         "cidx"
+
+#define LAYOUT_GRAPH_TAILS            0             /* exmem BFS reads tails from the relaid _BG_end_ */
+#define LAYOUT_BLOCK_EDGES            (DIRECT_IO_BLOCK_SIZE / sizeof(I64_t))
+#define LAYOUT_SUFFIX_DATA            "lay"
+#define LAYOUT_SUFFIX_INDEX           "lidx"
+
+#define COALESCE_MAX_REQUESTS         (1ULL << 10)
+#define COALESCE_GAP                  (1ULL << 12)  /* bytes */
+#define ENV_COALESCE_GAP              "COALESCE_GAP"
+
+#define NVM_EMULATION                 0             /* throttle file and far-memory I/O like an NVM device */
+#define NVM_EMU_LATENCY               10            /* us per request */
+#define NVM_EMU_BANDWIDTH             2000          /* MB/s per device */
+#define NVM_EMU_QUEUE_DEPTH           32            /* in-flight requests per device */
+#define NVM_EMU_MAX_DEVICES           32
+#define ENV_NVM_EMU_LATENCY           "NVM_EMU_LATENCY"
+#define ENV_NVM_EMU_BANDWIDTH         "NVM_EMU_BANDWIDTH"
+#define ENV_NVM_EMU_QUEUE_DEPTH       "NVM_EMU_QUEUE_DEPTH"
 
 #define ENV_EXMEM_CONF_FILE     "EXMEM_CONF_FILE"
 #define FNAME_EXMEM_CONF        "exmem.conf"
@@ -46,6 +95,20 @@
 #define PROFILE_DETAIL          0
 #define DUMP_TE_PROFILE         0
 #define ENV_DUMP_TE_PROFILE     "DUMP_TE_PROFILE"
+#define PROFILE_IO              0     /* per-level I/O statistics of the exmem BFS */
+#define ENV_IO_PROFILE          "IO_PROFILE"
+
+/* -----------------------------
+ * profile-guided edge placement
+ * ----------------------------- */
+// PLACEMENT_PROFILE == 1 : exmem BFS records #edges read from NVM per vertex
+//                          and dumps them to [GRAPH]_BG_plcmt_SCALE[scale]_[node]_
+// PLACEMENT_MAP=1        : restore promotes the hottest tails into DRAM
+// PLACEMENT_BUDGET=EDGES : #promoted tail edges per node
+//                          (default: the budget of the -f baseline rule)
+#define PLACEMENT_PROFILE       0
+#define ENV_PLACEMENT_MAP       "PLACEMENT_MAP"
+#define ENV_PLACEMENT_BUDGET    "PLACEMENT_BUDGET"
 
 
 /* -----------------------------
@@ -68,10 +131,12 @@
 #define CONFIG_TREE     "TREE"
 #define CONFIG_SRCS     "SRCS"
 #define CONFIG_EDGEBCKT "EDGEBCKT"
+#define CONFIG_FARMEM   "FARMEM"
 /* -----------------------------
  * Macros
  * ----------------------------- */
 #define MIN(a, b) ((a) < (b) ? (a) : (b))
+#define MAX(a, b) ((a) > (b) ? (a) : (b))
 #define SWAP(x, y) do { typeof(x) temp_##x##y = x; x = y; y = temp_##x##y; } while (0)
 
 
@@ -95,7 +160,29 @@ extern int is_construction_only;
 struct file_info_t {
   int fd;
   FILE *fp;
-  char fname[256];
+  char fname[MAX_FNAME];
+
+  // -- striped layout (STRIPE_GRAPH_END) -- //
+  // stripe i of the file is on device (stripe_first + i) % num_stripes.
+  // num_stripes == 0 means a plain file.
+  int num_stripes;
+  int stripe_first;
+  int *stripe_fd;
+  char **stripe_fname;
+
+  // -- block-compressed end file (COMPRESS_GRAPH_END) -- //
+  // non-NULL means pread_file decodes the logical (uncompressed) range.
+  const struct compress_index_t *cindex;
+
+  // -- far-memory image (FARMEM in the conf file) -- //
+  // non-NULL means reads are served by loads from a copy of the file
+  // bound to the far-memory NUMA node, shared by the entries of the file.
+  unsigned char *farmem;
+  size_t farmem_size;
+  int is_farmem_owner;
+
+  // -- emulated device (NVM_EMULATION) -- //
+  int emu_dev;
 };
 struct dumpfiles_t {
 
@@ -107,6 +194,10 @@ struct dumpfiles_t {
   int num_files;
 
   struct file_info_t *file_info_list;
+
+  // -- block index of each NUMA node (compressed end files only) -- //
+  int num_cindex;
+  struct compress_index_t *cindex_list;
 };
 
 struct fname_base_list_t {
@@ -131,7 +222,11 @@ struct dumpfiles_t *init_dumpfile_info_graph(char *suffix, int is_start, int is_
 struct dumpfiles_t *init_dumpfile_info_tree(char *suffix);
 struct dumpfiles_t *init_dumpfile_info_hops(char *suffix);
 struct dumpfiles_t *init_dumpfile_info_edgelist_bucket(char *suffix, int num_bucket);
+struct dumpfiles_t *init_dumpfile_info_placement(char *suffix);
+struct dumpfiles_t *init_dumpfile_info_graph_compressed(int is_single_thrd);
 
+int  open_file_info(struct file_info_t *finfo, int flags);
+void close_file_info(struct file_info_t *finfo);
 void open_files_new(struct dumpfiles_t *DF);
 void open_files(struct dumpfiles_t *DF);
 void open_files_direct(struct dumpfiles_t *DF);
@@ -172,10 +267,32 @@ void dump_subgraph_fwrite(struct subgraph_t *subgraph_list, int num_graphs,
                           struct dumpfiles_t *DF_s, struct dumpfiles_t *DF_e);
 void free_subgraph(struct mempool_t *mempool_list, int num_graphs);
 void drop_pagecache_file(char *fname);
+void drop_pagecache_file_info(struct file_info_t *finfo);
+
+/* -----------------------------
+ * positional I/O through the (striped) file layout
+ * ----------------------------- */
+size_t pread_file(const struct file_info_t *finfo, void *buf, size_t len, size_t pos);
+size_t pwrite_file(const struct file_info_t *finfo, const void *buf, size_t len, size_t pos);
+size_t size_file(const struct file_info_t *finfo);
+void prefetch_file(const struct file_info_t *finfo, size_t len, size_t pos);
 
 /* -----------------------------
  * dump buffer
  * ----------------------------- */
+// a buffer consists of DUMP_BUF_SLOTS slots of DUMP_BUF_SLOT_SIZE bytes,
+// each of which holds DUMP_BUF_LENGTH edges (and the O_DIRECT windows).
+#if DIRECT_IO_BFS == 1
+#define DUMP_BUF_SLOT_SIZE \
+  ROUNDUP(DIRECT_CACHE_SIZE(DUMP_BUF_LENGTH * sizeof(I64_t)) + DIRECT_CACHE_SIZE(2 * sizeof(I64_t)), DIRECT_IO_BLOCK_SIZE)
+#else
+#define DUMP_BUF_SLOT_SIZE  ROUNDUP((DUMP_BUF_LENGTH + 1) * sizeof(I64_t), 64)
+#endif
+#if IO_WORKER_BFS == 1
+#define DUMP_BUF_SLOTS      IO_BATCHES_PER_THREAD
+#else
+#define DUMP_BUF_SLOTS      1
+#endif
 struct sub_dump_buffer_t {
   // I64_t *start; +start
   I64_t *buf;
@@ -191,6 +308,210 @@ struct dump_buffer_t *alloc_dump_buffer(int num_buffer);
 struct dump_buffer_t *alloc_dump_buffer_with_size(int num_buffer, size_t size);
 void free_dump_buffer(struct dump_buffer_t *BF);
 
+/* -----------------------------
+ * block aligned read with user-level cache (for O_DIRECT)
+ * ----------------------------- */
+struct direct_cache_t {
+  unsigned char *buf;   /* DIRECT_IO_BLOCK_SIZE aligned */
+  size_t size;          /* capacity in bytes */
+  size_t off;           /* file offset of buf[0] */
+  size_t valid;         /* #bytes cached from off */
+};
+#define DIRECT_CACHE_SIZE(len) \
+  (ROUNDUP((len), DIRECT_IO_BLOCK_SIZE) + DIRECT_IO_BLOCK_SIZE + DIRECT_IO_WINDOW_SIZE)
+
+void init_direct_cache(struct direct_cache_t *C, void *buf, size_t size);
+void *read_direct_cached(const struct file_info_t *finfo, struct direct_cache_t *C, size_t pos, size_t len);
+void *read_extent(const struct file_info_t *finfo, struct direct_cache_t *C, void *buf, size_t pos, size_t len);
+
+/* -----------------------------
+ * block-compressed end file
+ * ----------------------------- */
+// [GRAPH]_BG_end_SCALE[scale]_[node]_cmp  : blocks of COMPRESS_BLOCK_EDGES edges,
+//   { first edge, bits | #edges << 8, zigzag deltas packed in 'bits' bits each }
+// [GRAPH]_BG_end_SCALE[scale]_[node]_cidx : { #edges, #blocks, file offset of each block, file size }
+struct compress_index_t {
+  I64_t num_edges;
+  I64_t num_blocks;
+  I64_t *block_pos;   /* num_blocks+1 entries, kept in DRAM */
+};
+
+void compress_graph_end(int is_forced);
+
+#if COMPRESS_GRAPH_END == 1 && DIRECT_IO_BFS == 1
+#error "COMPRESS_GRAPH_END does not support DIRECT_IO_BFS"
+#endif
+#if PREFETCH_NEXT_LEVEL == 1 && DIRECT_IO_BFS == 1
+#error "PREFETCH_NEXT_LEVEL uses the page cache, which DIRECT_IO_BFS bypasses"
+#endif
+
+/* -----------------------------
+ * I/O worker threads
+ * ----------------------------- */
+// jobs posted to a queue are run in FIFO order by the workers of the queue,
+// which are pinned to the cores of the NUMA node of the queue.
+struct io_queue_t;
+struct io_stat_t;
+struct io_job_t {
+  void (*func)(struct io_job_t *job);
+  volatile int done;
+  struct io_queue_t *queue;
+  struct io_job_t *next;
+  struct io_stat_t *stat;   /* io_stat of the poster */
+};
+struct io_queue_t {
+  pthread_mutex_t lock;
+  pthread_cond_t posted;
+  pthread_cond_t completed;
+  struct io_job_t *head, *tail;
+  int nodeid;
+  int is_shutdown;
+  int num_workers;
+  pthread_t *workers;
+};
+struct io_workers_t {
+  int num_queues;
+  struct io_queue_t *queues;
+};
+
+struct io_workers_t *start_io_workers(int num_queues, int threads_per_queue);
+void post_io_job(struct io_workers_t *W, int queue_no, struct io_job_t *job);
+void wait_io_job(struct io_job_t *job);
+void stop_io_workers(struct io_workers_t *W);
+
+/* -----------------------------
+ * coalesced read of sorted extents
+ * ----------------------------- */
+struct read_extent_t {
+  I64_t pos;      /* #I64_t from the head of file */
+  I64_t len;      /* #I64_t */
+  I64_t *data;    /* NULL if the extent is larger than the buffer */
+};
+
+I64_t read_coalesced_extents(const struct file_info_t *finfo, struct direct_cache_t *C, I64_t *buf, I64_t buf_length,
+                             struct read_extent_t *ext, I64_t r, I64_t num_ext, I64_t max_gap);
+
+
+/* -----------------------------
+ * profile-guided placement
+ * ----------------------------- */
+struct placement_map_t {
+  int num_maps;
+  I64_t *promoted_edges;
+  unsigned long **promoted;   /* node-local bitmap of vertices whose tail is on DRAM */
+};
+
+void dump_placement_profile(I64_t **exmem_access, struct graph_t *G);
+struct placement_map_t *load_placement_map(I64_t num_nodes, int num_lists);
+void free_placement_map(struct placement_map_t *PM);
+I64_t get_onmem_degree(const struct placement_map_t *PM, int nodeid, I64_t j, I64_t dg);
+
+/* -----------------------------
+ * bulk loading of the on-DRAM graph
+ * ----------------------------- */
+// a thread loads vertices [ls, le) of node nodeid. start[] entries are read
+// LOAD_START_BLOCK at a time, and adjacency prefixes by one pread per run of
+// vertices that are contiguous in the end file and on DRAM.
+#define LOAD_START_BLOCK        (1ULL << 16)  /* start[] entries */
+// sums the on-DRAM degrees, and stores the degree of vertex j into
+// degree[j-ls] unless degree is NULL.
+I64_t load_onmem_degrees(const struct file_info_t *fi_s, const struct placement_map_t *PM,
+                         int nodeid, I64_t ls, I64_t le, I64_t *degree);
+// reads the on-DRAM prefix of vertex j into end[start[j]...].
+void load_onmem_adjacency(const struct file_info_t *fi_s, const struct file_info_t *fi_e,
+                          const struct placement_map_t *PM, int nodeid, I64_t ls, I64_t le,
+                          const I64_t *start, I64_t *end);
+
+
+/* -----------------------------
+ * tail signatures
+ * ----------------------------- */
+// TAIL_SIGNATURE == 1 : graph construction records a 64-bit mask of the vertex-ID
+//                       blocks (n/64 vertices each) hit by the external tail of each
+//                       vertex, and the exmem BFS skips a tail whose mask has no block
+//                       of the frontier (bottom-up) or no unvisited block (top-down).
+#define TAIL_SIGNATURE          0
+#define TAIL_SIG_BLOCK(v)       ( 1UL << ((unsigned long)(v) >> tail_sig_shift) )
+
+extern unsigned long *tail_sig[MAX_NODES];   /* node-local vertex ID */
+extern int tail_sig_shift;
+
+void build_tail_signatures(struct graph_t *G);
+void free_tail_signatures(struct graph_t *G);
+
+
+/* -----------------------------
+ * layout of external tails
+ * ----------------------------- */
+// [GRAPH]_BG_end_SCALE[scale]_[node]_lay  : the external tails only. tails of at least
+//   LAYOUT_BLOCK_EDGES edges (hubs) come first as a hot region, each starting at a block
+//   boundary; the other tails follow in vertex-ID order and never straddle a block.
+// [GRAPH]_BG_end_SCALE[scale]_[node]_lidx : { #vertices, hash of the DRAM split,
+//   size of the hot region, size of the file, #tail edges (#I64_t), position of each tail }
+// the layout depends on the DRAM degree of each vertex, so it is rebuilt when the
+// split differs from the one it was written for.
+extern I64_t *tail_layout[MAX_NODES];   /* node-local vertex ID -> #I64_t in _lay */
+
+void layout_graph_tails(struct graph_t *G, int is_forced);
+void free_tail_layout(struct graph_t *G);
+
+#if LAYOUT_GRAPH_TAILS == 1 && COMPRESS_GRAPH_END == 1
+#error "LAYOUT_GRAPH_TAILS and COMPRESS_GRAPH_END both replace the end file of the BFS"
+#endif
+
+
+/* -----------------------------
+ * far-memory backend
+ * ----------------------------- */
+// FARMEM [node] in the conf file keeps the external structures read by the exmem BFS
+// and validation (CSR index, external tails, edge list) in memory bound to a CPU-less
+// NUMA node (CXL, PMEM in memory mode) instead of reading them from files. the split
+// between DRAM and external edges is unchanged.
+int get_farmem_nodeid(void);   /* -1 if FARMEM is not given */
+void load_files_farmem(struct dumpfiles_t *DF, int farmem_nodeid);
+
+
+/* -----------------------------
+ * NVM device emulation
+ * ----------------------------- */
+// NVM_EMULATION == 1 : each directory of the conf file paths (and the far memory) is an
+//   emulated device. a request waits for one of NVM_EMU_QUEUE_DEPTH slots, its transfer
+//   is serialized at NVM_EMU_BANDWIDTH on the device, and it completes NVM_EMU_LATENCY
+//   after the transfer, however fast the backing store (page cache, tmpfs, DRAM) was.
+struct nvm_request_t {
+  int dev;
+  double deadline;   /* seconds */
+};
+
+void begin_nvm_request(const struct file_info_t *finfo, size_t len, struct nvm_request_t *R);
+void end_nvm_request(struct nvm_request_t *R);
+
+
+/* -----------------------------
+ * I/O statistics
+ * ----------------------------- */
+// PROFILE_IO == 1 : the requests of a thread (and of the I/O workers on its behalf) are
+//   recorded in its io_stat. histograms have 4 log-linear buckets per power of two.
+#define IO_HIST_BUCKETS         256
+
+struct io_stat_t {
+  long requests;          /* reads and writes of a file or the far memory */
+  long syscalls;          /* pread, pwrite, posix_fadvise */
+  long bytes;             /* bytes requested */
+  long needed_bytes;      /* bytes the caller used (set by the caller) */
+  long io_nsec;           /* time in requests */
+  long blocked_nsec;      /* time the thread itself waited for requests or I/O workers */
+  long size_hist[IO_HIST_BUCKETS];      /* bytes */
+  long latency_hist[IO_HIST_BUCKETS];   /* nanoseconds */
+};
+
+extern __thread struct io_stat_t *io_stat;   /* NULL: not recorded */
+
+int io_hist_bucket(unsigned long x);
+unsigned long io_hist_value(int b);
+unsigned long io_hist_percentile(const long *hist, double p);
+double monotonic_seconds(void);
+
 
 /* -----------------------------
  * utility
@@ -36,6 +36,7 @@
 #include <sys/stat.h>
 #include <fcntl.h>
 #include <sys/mman.h>
+#include <pthread.h>
 
 #include "generation.h"
 #include "construction.h"
@@ -44,28 +45,45 @@
 #include "defs.h"
 #include "dump.h"
 #include "std_sort.h"
+#include "sort_adjacency.h"
 #include "external_full_construction_bucket.h"
 
 static void mmap_edges (struct edgelist_t *list, struct dumpfiles_t *DF_E);
 
-static I64_t *count_edgebucket_size(struct edgelist_t *list, I64_t num_bucket);
+static I64_t num_edgebuckets(const struct edgelist_t *list);
+
+/* edges streamed into buckets by the generator (see open_edgebucket_stream) */
+struct edgebucket_stream_t {
+  I64_t num_buckets;
+  I64_t log_c_b;
+  struct dumpfiles_t *DF_B;
+  I64_t *length;                /* #edges of each bucket */
+  I64_t *fm;                    /* [thread][bucket] #edges without self-loops */
+  I64_t *degree;                /* [vertex] #edges without self-loops */
+  pthread_mutex_t *lock;        /* [bucket] */
+  I64_t *self_loops;            /* [thread] */
+  struct bucket_writer_t *W;    /* [thread] */
+};
+
+static I64_t *count_edgebucket_size(struct edgelist_t *list, I64_t num_bucket, I64_t *thread_offset);
 static struct edgelist_t *allocate_edgebucket_mmap(struct edgelist_t *list, int num_buckets,
  struct dumpfiles_t *DF_B, I64_t *bucket_size_list);
-static I64_t *divide_edges_into_buckets (struct edgelist_t *list, struct edgelist_t *list_bucket);
+static I64_t *divide_edges_into_buckets (struct edgelist_t *list, struct edgelist_t *list_bucket,
+ struct dumpfiles_t *DF_B, I64_t *thread_offset, I64_t *degree);
 
 static I64_t *graph_construction_onebyone(struct edgelist_t *list,
  struct edgelist_t *list_full, I64_t *num_edges,
- struct dumpfiles_t *DF_B);
+ struct dumpfiles_t *DF_B, I64_t *degree);
 
 static struct graph_t *allocate_graph_info(struct edgelist_t *list, I64_t num_nodes, I64_t *num_edges);
 static void allocate_subgraph(struct graph_t *G, int graph_no);
 static I64_t count_node_degree(struct graph_t *G, struct edgelist_t *list, int graph_no);
 static int parallel_prefix_sum(struct graph_t *G, int graph_no);
 static void construct_subgraphs(struct graph_t *G, struct edgelist_t *list, int graph_no);
-static void extract_duplicated_edges(struct graph_t *G);
+static void update_degree_table(struct graph_t *G, const I64_t *degree);
+static void sort_adjacency_list_by_degree(struct graph_t *G, int subgraph_no);
+static void dump_degree_distribution(struct graph_t *G);
 
-static void dump_subgraph_with_merging_files(struct graph_t *G, struct graph_t *G_full,
-                                             int subgraph_no, I64_t offset);
 
 static void free_graph_info(struct graph_t *G);
 
@@ -76,38 +94,75 @@ I64_t *external_full_graph_construction(struct edgelist_t *list, struct dumpfile
   DF_E_dmy = DF_E_dmy; // dummy
 
   int k;
-  struct dumpfiles_t *DF_E_sth = init_dumpfile_info_edgelist("", 1);
-  open_files(DF_E_sth);
-  mmap_edges(list, DF_E_sth);
-
-  printf("open edgelist bucket files\n");
-  I64_t num_buckets = ROUNDUP(ROUNDUP(get_numa_num_threads(), list->num_lists), 64);
-  struct dumpfiles_t *DF_B = init_dumpfile_info_edgelist_bucket("", num_buckets);
-  open_files_new(DF_B);
-
+  I64_t num_buckets = num_edgebuckets(list);
+  struct dumpfiles_t *DF_B = NULL;
+  struct edgelist_t *list_bucket = NULL;
+  I64_t *bucket_size_list = NULL;
+  I64_t *ne = NULL;
+  I64_t *degree = NULL;
+
+  if (list->buckets) {
+    /* the generator has already divided the edges into buckets */
+    struct edgebucket_stream_t *S = list->buckets;
+    assert( S->num_buckets == num_buckets );
+    DF_B = S->DF_B;
+    bucket_size_list = S->length;
+    degree = S->degree;
+    assert( ne = (I64_t *)calloc(num_buckets, sizeof(I64_t)) );
+    for (int t = 0; t < get_numa_num_threads(); ++t) {
+      for (k = 0; k < num_buckets; ++k) {
+        ne[k] += S->fm[t * num_buckets + k];
+      }
+    }
+    free(S->fm);
+    free(S);
+    list->buckets = NULL;
 
-  printf("counting edgebucket size ....\n");
-  I64_t *bucket_size_list = count_edgebucket_size(list, num_buckets);
-  printf("length of edgebucket = {\n");
-  for (k=0; k < num_buckets; k++) {
-    printf ("[%2d] = %lld\n", k, bucket_size_list[k]);
-  }
-  printf ("}\n");
-  struct edgelist_t *list_bucket = allocate_edgebucket_mmap(list, num_buckets, DF_B, bucket_size_list);
+    printf("length of edgebucket = {\n");
+    for (k=0; k < num_buckets; k++) {
+      printf ("[%2d] = %lld\n", k, bucket_size_list[k]);
+    }
+    printf ("}\n");
+    list_bucket = allocate_edgebucket_mmap(list, num_buckets, DF_B, bucket_size_list);
+
+  } else {
+    struct dumpfiles_t *DF_E_sth = init_dumpfile_info_edgelist("", 1);
+    open_files(DF_E_sth);
+    mmap_edges(list, DF_E_sth);
+
+    printf("open edgelist bucket files\n");
+    DF_B = init_dumpfile_info_edgelist_bucket("", num_buckets);
+    open_files_new(DF_B);
+
+
+    printf("counting edgebucket size ....\n");
+    I64_t *thread_offset = NULL;
+    assert( thread_offset = (I64_t *)calloc(get_numa_num_threads() * num_buckets, sizeof(I64_t)) );
+    assert( degree = (I64_t *)calloc(list->num_nodes, sizeof(I64_t)) );
+    bucket_size_list = count_edgebucket_size(list, num_buckets, thread_offset);
+    printf("length of edgebucket = {\n");
+    for (k=0; k < num_buckets; k++) {
+      printf ("[%2d] = %lld\n", k, bucket_size_list[k]);
+    }
+    printf ("}\n");
+    list_bucket = allocate_edgebucket_mmap(list, num_buckets, DF_B, bucket_size_list);
 
-  printf("divide edges into buckets ....\n");
-  double t1 = get_seconds();
-  I64_t *ne = divide_edges_into_buckets(list, list_bucket);
-  double t2 = get_seconds();
-  printf ("done. takes %6.2f seconds\n", (t2-t1));
-  printf("drop page caches and unmap pools for edgelist\n\n");
-  for (k = 0; k < list->num_lists; ++k) {
-    drop_pagecaches_pool(&(list->pool[k]));
-    unmap_pool(&(list->pool[k]));
+    printf("divide edges into buckets ....\n");
+    double t1 = get_seconds();
+    ne = divide_edges_into_buckets(list, list_bucket, DF_B, thread_offset, degree);
+    double t2 = get_seconds();
+    printf ("done. takes %6.2f seconds (%.2f MB/s)\n", (t2-t1),
+            list_bucket->num_edges * sizeof(struct packed_edge) / MAX(t2-t1, 1e-9) / (1ULL<<20));
+    free(thread_offset);
+    printf("drop page caches and unmap pools for edgelist\n\n");
+    for (k = 0; k < list->num_lists; ++k) {
+      drop_pagecaches_pool(&(list->pool[k]));
+      unmap_pool(&(list->pool[k]));
+    }
+    close_files(DF_E_sth);
   }
-  close_files(DF_E_sth);
 
-  I64_t *ne_onmem = graph_construction_onebyone(list_bucket, list, ne, DF_B);
+  I64_t *ne_onmem = graph_construction_onebyone(list_bucket, list, ne, DF_B, degree);
 
   // printf("drop page caches and unmap pools for edgelist\n");
   // for (k = 0; k < list_bucket->num_lists; ++k) {
@@ -154,10 +209,20 @@ static void mmap_edges (struct edgelist_t *list, struct dumpfiles_t *DF_E)
 
 
 
+/* ------------------------------------------------------------
+ * num_edgebuckets
+ * ------------------------------------------------------------ */
+static I64_t num_edgebuckets(const struct edgelist_t *list) {
+  return ROUNDUP(ROUNDUP(get_numa_num_threads(), list->num_lists), 64);
+}
+
+
 /* ------------------------------------------------------------
  * count_edgelist_size
+ *   also keeps the count of each thread for each bucket in
+ *   thread_offset[id * num_buckets + k].
  * ------------------------------------------------------------ */
- static I64_t *count_edgebucket_size(struct edgelist_t *list, I64_t num_buckets) {
+ static I64_t *count_edgebucket_size(struct edgelist_t *list, I64_t num_buckets, I64_t *thread_offset) {
   I64_t *ne = NULL;
   I64_t chunk = ROUNDUP(list->num_nodes/num_buckets, 64);
   I64_t log_c = log2(chunk);
@@ -196,6 +261,7 @@ static void mmap_edges (struct edgelist_t *list, struct dumpfiles_t *DF_E)
 
     for (int k = 0; k < num_buckets; ++k) {
       SYNC_FETCH_AND_ADD(&ne[k], fm[k]);
+      thread_offset[id * num_buckets + k] = fm[k];
     }
 
     OMP("omp barrier");
@@ -260,18 +326,140 @@ static struct edgelist_t *allocate_edgebucket_mmap(struct edgelist_t *list_sourc
 
 
 
-static I64_t *divide_edges_into_buckets (struct edgelist_t *list_source, struct edgelist_t *list_bucket)
+/* ------------------------------------------------------------
+ * bucket writer
+ *   a thread splits BUCKET_WRITE_BYTES of staging over the buckets (at
+ *   least one BUCKET_WRITE_ALIGN unit of edges each) and writes the
+ *   staged edges of a bucket by a single pwrite to its own range of the
+ *   bucket file, or to the next range claimed from claim[] if the sizes
+ *   are not known. the first flush of an own range is shortened so that
+ *   the following ones start and end at BUCKET_WRITE_ALIGN offsets;
+ *   claimed ranges are whole units from the start of the file.
+ *   the staged edges of a bucket start from its own vertices, so a flush
+ *   also counts their degrees into the bucket's range of degree[],
+ *   holding the lock of the bucket once instead of an atomic per edge.
+ * ------------------------------------------------------------ */
+struct bucket_writer_t {
+  const struct dumpfiles_t *DF;
+  struct packed_edge *buf;    /* [num_buckets][cap] */
+  I64_t cap;                  /* #edges staged for each bucket */
+  I64_t *fill;                /* #staged edges of each bucket */
+  I64_t *limit;               /* #edges to stage before the next flush */
+  I64_t *pos;                 /* next edge of each bucket in the file */
+  I64_t *claim;               /* #claimed edges of each bucket, or NULL */
+  I64_t *degree;              /* [vertex] #edges without self-loops */
+  pthread_mutex_t *lock;      /* [bucket] guards the bucket's range of degree[] */
+};
+
+static I64_t gcd_i64(I64_t a, I64_t b) {
+  while (b) {
+    const I64_t t = a % b;
+    a = b, b = t;
+  }
+  return a;
+}
+
+// #edges of a BUCKET_WRITE_ALIGN aligned unit
+static I64_t bucket_align_edges(void) {
+  return BUCKET_WRITE_ALIGN / gcd_i64(BUCKET_WRITE_ALIGN, sizeof(struct packed_edge));
+}
+
+// pos is the first edge of each bucket in the file, or NULL with claim.
+static void init_bucket_writer(struct bucket_writer_t *W, const struct dumpfiles_t *DF, I64_t num_buckets,
+                               I64_t *pos, I64_t *claim, I64_t *degree, pthread_mutex_t *lock) {
+  const I64_t unit = bucket_align_edges();
+  I64_t cap = BUCKET_WRITE_BYTES / sizeof(struct packed_edge) / num_buckets / unit * unit;
+  if (cap < unit) cap = unit;
+  W->DF     = DF;
+  W->cap    = cap;
+  W->claim  = claim;
+  W->degree = degree;
+  W->lock   = lock;
+  assert( W->buf   = (struct packed_edge *)malloc(num_buckets * cap * sizeof(struct packed_edge)) );
+  assert( W->fill  = (I64_t *)calloc(num_buckets, sizeof(I64_t)) );
+  assert( W->limit = (I64_t *)calloc(num_buckets, sizeof(I64_t)) );
+  if (pos) {
+    W->pos = pos;
+  } else {
+    assert( W->pos = (I64_t *)calloc(num_buckets, sizeof(I64_t)) );
+  }
+  for (I64_t k = 0; k < num_buckets; ++k) {
+    W->limit[k] = claim ? cap : cap - W->pos[k] % unit;
+  }
+}
+
+static void free_bucket_writer(struct bucket_writer_t *W) {
+  free(W->buf);
+  free(W->fill);
+  free(W->limit);
+  if (W->claim) free(W->pos);
+}
+
+static void count_bucket_writer(struct bucket_writer_t *W, I64_t k) {
+  const struct packed_edge *E = &W->buf[k * W->cap];
+  I64_t *degree = W->degree;
+  pthread_mutex_lock(&W->lock[k]);
+  for (I64_t i = 0; i < W->fill[k]; ++i) {
+    const I64_t v = get_v0_from_edge(&E[i]);
+    if (v != get_v1_from_edge(&E[i])) ++degree[v];
+  }
+  pthread_mutex_unlock(&W->lock[k]);
+}
+
+static void flush_bucket_writer(struct bucket_writer_t *W, I64_t k) {
+  const size_t len = W->fill[k] * sizeof(struct packed_edge);
+  if (len == 0) return ;
+  count_bucket_writer(W, k);
+  if (W->claim) {
+    W->pos[k] = SYNC_FETCH_AND_ADD(&W->claim[k], W->fill[k]);
+  }
+  size_t written = pwrite_file(&W->DF->file_info_list[k], &W->buf[k * W->cap],
+                               len, W->pos[k] * sizeof(struct packed_edge));
+  if (written != len) {
+    fprintf(stderr, "[error] flush_bucket_writer: %s, pos=%lld, len=%zu\n",
+            W->DF->file_info_list[k].fname, W->pos[k], len);
+    exit(1);
+  }
+  W->pos[k] += W->fill[k];
+  W->fill[k] = 0;
+  W->limit[k] = W->cap;
+}
+
+static inline void append_bucket_writer(struct bucket_writer_t *W, I64_t k, const struct packed_edge *e) {
+  W->buf[ k * W->cap + W->fill[k]++ ] = *e;
+  if (W->fill[k] == W->limit[k]) {
+    flush_bucket_writer(W, k);
+  }
+}
+
+
+static I64_t *divide_edges_into_buckets (struct edgelist_t *list_source, struct edgelist_t *list_bucket,
+                                         struct dumpfiles_t *DF_B, I64_t *thread_offset, I64_t *degree)
 {
 
   I64_t chunk_b = ROUNDUP(list_bucket->num_nodes/list_bucket->num_lists, 64ULL);
   I64_t log_c_b = log2(chunk_b);
+  const I64_t num_buckets = list_bucket->num_lists;
 
   I64_t self_loops = 0;
   I64_t *ne;
-  assert( ne = (I64_t *)calloc(list_bucket->num_lists, sizeof(I64_t)) );
+  assert( ne = (I64_t *)calloc(num_buckets, sizeof(I64_t)) );
+  pthread_mutex_t *lock = NULL;
+  assert( lock = (pthread_mutex_t *)malloc(num_buckets * sizeof(pthread_mutex_t)) );
+  for (int k = 0; k < num_buckets; ++k) {
+    pthread_mutex_init(&lock[k], NULL);
+  }
 
-  I64_t *bucket_length_list;
-  assert( bucket_length_list = (I64_t *)CALLOCA(list_bucket->num_lists * sizeof(I64_t)) );
+  /* the counts of each thread to its range of each bucket */
+  for (int k = 0; k < num_buckets; ++k) {
+    I64_t sum = 0;
+    for (int t = 0; t < get_numa_num_threads(); ++t) {
+      const I64_t c = thread_offset[t * num_buckets + k];
+      thread_offset[t * num_buckets + k] = sum;
+      sum += c;
+    }
+    assert( list_bucket->IJ_list[k].length == sum );
+  }
 
   OMP("omp parallel num_threads(get_numa_num_threads()) reduction(+:self_loops)") {
     int id = omp_get_thread_num();
@@ -282,7 +470,7 @@ static I64_t *divide_edges_into_buckets (struct edgelist_t *list_source, struct
     OMP("omp barrier");
 
     I64_t i, ls, le;
-    I64_t *fm = (I64_t *)CALLOCA(list_bucket->num_lists * sizeof(I64_t));
+    I64_t *fm = (I64_t *)CALLOCA(num_buckets * sizeof(I64_t));
     struct IJ_list_t *IJ_list = &list_source->IJ_list[nodeid];
     partial_range(IJ_list->length, 0, lcores, coreid, &ls, &le);
     struct packed_edge *E = IJ_list->edges;
@@ -291,20 +479,19 @@ static I64_t *divide_edges_into_buckets (struct edgelist_t *list_source, struct
       if (err == -1)
         perror("madvice seaquential divide_edges_into_buckets");
     }
+
+    struct bucket_writer_t W;
+    init_bucket_writer(&W, DF_B, num_buckets, &thread_offset[id * num_buckets], NULL, degree, lock);
     OMP("omp barrier");
 
     for (i = ls; i < le; i++) {
 
       I64_t v = get_v0_from_edge(&E[i]);
-      I64_t target_no_1 = v >> log_c_b;
-      struct IJ_list_t *IJ_list_bucket_1 = &(list_bucket->IJ_list[target_no_1]);
-      IJ_list_bucket_1->edges[ SYNC_FETCH_AND_ADD(&bucket_length_list[target_no_1], 1) ] = E[i];
+      append_bucket_writer(&W, v >> log_c_b, &E[i]);
 
       I64_t w = get_v1_from_edge(&E[i]);
       struct packed_edge r_edge; write_edge(&r_edge, w, v);
-      I64_t target_no_2 = w >> log_c_b;
-      struct IJ_list_t *IJ_list_bucket_2 = &(list_bucket->IJ_list[target_no_2]);
-      IJ_list_bucket_2->edges[ SYNC_FETCH_AND_ADD(&bucket_length_list[target_no_2], 1) ] = r_edge;
+      append_bucket_writer(&W, w >> log_c_b, &r_edge);
 
       if (v != w) {
 
@@ -317,29 +504,252 @@ static I64_t *divide_edges_into_buckets (struct edgelist_t *list_source, struct
     }
 
     int k;
-    for (k = 0; k < list_bucket->num_lists; ++k) {
+    for (k = 0; k < num_buckets; ++k) {
+      flush_bucket_writer(&W, k);
       SYNC_FETCH_AND_ADD(&ne[k], fm[k]);
     }
+    free_bucket_writer(&W);
 
     clear_affinity();
   }
   printf("# of self-loops is %lld\n", self_loops);
 
-  for (int k = 0; k < list_bucket->num_lists; k++) {
-    assert( list_bucket->IJ_list[k].length == bucket_length_list[k] );
+  /* every range is filled up to the start of the next thread's */
+  for (int k = 0; k < num_buckets; k++) {
+    const int last = get_numa_num_threads() - 1;
+    assert( thread_offset[last * num_buckets + k] == list_bucket->IJ_list[k].length );
+    pthread_mutex_destroy(&lock[k]);
   }
+  free(lock);
 
   return ne;
 
 }
 
 
+/* ------------------------------------------------------------
+ * edge bucket stream
+ *   the generator threads append their edges and the reverse edges
+ *   to bucket writers while generating, so that construction does not
+ *   read the EDGELIST files. each flush claims the next range of the
+ *   bucket file; the order of the edges in a bucket does not matter
+ *   because adjacency lists are sorted later.
+ * ------------------------------------------------------------ */
+struct edgebucket_stream_t *open_edgebucket_stream(const struct edgelist_t *list) {
+  struct edgebucket_stream_t *S = NULL;
+  assert( S = (struct edgebucket_stream_t *)calloc(1, sizeof(struct edgebucket_stream_t)) );
+
+  const int threads = get_numa_num_threads();
+  S->num_buckets = num_edgebuckets(list);
+  S->log_c_b = log2(ROUNDUP(list->num_nodes/S->num_buckets, 64ULL));
+
+  printf("open edgelist bucket files\n");
+  S->DF_B = init_dumpfile_info_edgelist_bucket("", S->num_buckets);
+  open_files_new(S->DF_B);
+
+  assert( S->length     = (I64_t *)calloc(S->num_buckets, sizeof(I64_t)) );
+  assert( S->fm         = (I64_t *)calloc(threads * S->num_buckets, sizeof(I64_t)) );
+  assert( S->degree     = (I64_t *)calloc(list->num_nodes, sizeof(I64_t)) );
+  assert( S->lock       = (pthread_mutex_t *)malloc(S->num_buckets * sizeof(pthread_mutex_t)) );
+  for (I64_t k = 0; k < S->num_buckets; ++k) {
+    pthread_mutex_init(&S->lock[k], NULL);
+  }
+  assert( S->self_loops = (I64_t *)calloc(threads, sizeof(I64_t)) );
+  assert( S->W          = (struct bucket_writer_t *)calloc(threads, sizeof(struct bucket_writer_t)) );
+  for (int t = 0; t < threads; ++t) {
+    init_bucket_writer(&S->W[t], S->DF_B, S->num_buckets, NULL, S->length, S->degree, S->lock);
+  }
+  printf("stage %lld edges per bucket and thread (%.1f MB per thread)\n", S->W[0].cap,
+         (double)(S->num_buckets * S->W[0].cap * sizeof(struct packed_edge)) / (1ULL<<20));
+
+  return S;
+}
+
+void append_edgebucket_stream(struct edgebucket_stream_t *S, int id,
+                              const struct packed_edge *E, I64_t n) {
+  struct bucket_writer_t *W = &S->W[id];
+  I64_t *fm = &S->fm[id * S->num_buckets];
+  const I64_t log_c_b = S->log_c_b;
+
+  for (I64_t i = 0; i < n; i++) {
+    I64_t v = get_v0_from_edge(&E[i]);
+    append_bucket_writer(W, v >> log_c_b, &E[i]);
+
+    I64_t w = get_v1_from_edge(&E[i]);
+    struct packed_edge r_edge; write_edge(&r_edge, w, v);
+    append_bucket_writer(W, w >> log_c_b, &r_edge);
+
+    if (v != w) {
+      ++fm[w >> log_c_b];
+      ++fm[v >> log_c_b];
+    } else {
+      ++S->self_loops[id];
+    }
+  }
+}
+
+void close_edgebucket_stream(struct edgebucket_stream_t *S) {
+  I64_t self_loops = 0;
+  for (int t = 0; t < get_numa_num_threads(); ++t) {
+    struct bucket_writer_t *W = &S->W[t];
+    for (I64_t k = 0; k < S->num_buckets; ++k) {
+      flush_bucket_writer(W, k);
+    }
+    free_bucket_writer(W);
+    self_loops += S->self_loops[t];
+  }
+  for (I64_t k = 0; k < S->num_buckets; ++k) {
+    pthread_mutex_destroy(&S->lock[k]);
+  }
+  free(S->W);
+  free(S->self_loops);
+  free(S->lock);
+  S->W = NULL;
+  S->self_loops = NULL;
+  S->lock = NULL;
+  printf("# of self-loops is %lld\n", self_loops);
+}
+
+
 static I64_t  degree_max = 0;
 static I64_t  degree_min = 0;
+static unsigned char *degree_table_code = NULL;
+
+
+/* ------------------------------------------------------------
+ * bucket pipeline
+ *   write(k-1) and read(k+1) run on an I/O thread while the OpenMP
+ *   threads run build(k), so a bucket takes the slower of its I/O and
+ *   its CPU work instead of the sum. at most three subgraphs are in
+ *   flight, so the peak DRAM is still bounded by the bucket size.
+ * ------------------------------------------------------------ */
+struct bucket_stage_t {
+  void (*read)(void *arg, int k);
+  void (*build)(void *arg, int k);
+  void (*write)(void *arg, int k);
+  void *arg;
+  int read_no;                  /* -1: none */
+  int write_no;                 /* -1: none */
+};
+
+static void *run_bucket_io(void *p) {
+  struct bucket_stage_t *S = (struct bucket_stage_t *)p;
+  if (S->write_no >= 0) S->write(S->arg, S->write_no);
+  if (S->read_no  >= 0) S->read (S->arg, S->read_no);
+  return NULL;
+}
+
+static void run_bucket_pipeline(struct bucket_stage_t *S, int num_buckets) {
+  S->write_no = -1;
+  S->read_no  = 0;
+  run_bucket_io(S);
+
+  for (int k = 0; k < num_buckets; ++k) {
+    const double t1 = get_seconds();
+#if PIPELINE_CONSTRUCTION == 1
+    S->write_no = k-1;
+    S->read_no  = (k+1 < num_buckets) ? k+1 : -1;
+    pthread_t io;
+    assert( !pthread_create(&io, NULL, run_bucket_io, S) );
+    S->build(S->arg, k);
+    const double t2 = get_seconds();
+    assert( !pthread_join(io, NULL) );
+#else
+    S->build(S->arg, k);
+    const double t2 = get_seconds();
+    S->write_no = k;
+    S->read_no  = (k+1 < num_buckets) ? k+1 : -1;
+    run_bucket_io(S);
+#endif
+    const double t3 = get_seconds();
+    printf("[bucket %d] build %.3f seconds, waiting for I/O %.3f seconds\n", k, t2-t1, t3-t2);
+  }
+
+#if PIPELINE_CONSTRUCTION == 1
+  S->write_no = num_buckets-1;
+  S->read_no  = -1;
+  run_bucket_io(S);
+#endif
+}
+
+
+/* ------------------------------------------------------------
+ * stages of graph_construction_onebyone
+ * ------------------------------------------------------------ */
+struct onebyone_t {
+  struct graph_t *G;
+  struct graph_t *G_full;
+  struct edgelist_t *list;
+  struct dumpfiles_t *DF_B;
+  I64_t *degree;                /* [vertex] degree without duplicated edges */
+  I64_t offset;                 /* start[] of the subgraph in its merged file */
+};
+
+static void merge_subgraph_info(struct graph_t *G, struct graph_t *G_full, int subgraph_no);
+
+static void read_bucket(void *arg, int k) {
+  struct onebyone_t *O = (struct onebyone_t *)arg;
+  struct mempool_t *pool = &O->list->pool[k];
+  const size_t sz = O->list->IJ_list[k].length * sizeof(struct packed_edge);
+  const size_t pgsz = getpagesize();
+  if (madvise((void *)pool->pool, pool->memsize, MADV_WILLNEED) == -1)
+    perror("madvice willneed read_bucket");
+  volatile unsigned char sum = 0;
+  for (size_t off = 0; off < sz; off += pgsz) {
+    sum += pool->pool[off];
+  }
+}
+
+static void build_bucket(void *arg, int k) {
+  struct onebyone_t *O = (struct onebyone_t *)arg;
+  struct graph_t *G = O->G;
+  const double s_time1 = get_seconds();
+  printf("-- construct subgraph [%d] --\n", k);
+  allocate_subgraph(G, k);
+  count_node_degree(G, O->list, k);
+  printf("[elapsed: %6.2fs] finished: count each vertex degree\n", get_seconds()-s_time1);
+  parallel_prefix_sum(G, k);
+  printf("[elapsed: %6.2fs] finished: parallel prefix sum\n", get_seconds()-s_time1);
+  construct_subgraphs(G, O->list, k);
+  printf("[elapsed: %6.2fs] finished: construct sub-graphs\n", get_seconds()-s_time1);
+
+  /* sort by degree and remove duplicated edges while the subgraph is in DRAM */
+  struct subgraph_t *BG = &G->BG_list[k];
+  const int lgraphs = G->num_graphs / O->G_full->num_graphs;
+  if (k % lgraphs == 0) O->offset = 0;
+  sort_adjacency_list_by_degree(G, k);
+  O->offset += compact_adjacency_lists(BG, 1, 0, O->offset);
+  printf("[elapsed: %6.2fs] finished: extract duplicated edges\n", get_seconds()-s_time1);
+
+  I64_t *degree = &O->degree[BG->offset];
+  OMP("omp parallel num_threads(get_numa_num_threads())") {
+    I64_t j, ls, le;
+    partial_range(BG->n, 0, get_numa_num_threads(), omp_get_thread_num(), &ls, &le);
+    for (j = ls; j < le; ++j) {
+      degree[j] = BG->start[j+1] - BG->start[j];
+    }
+  }
+  merge_subgraph_info(G, O->G_full, k);
+
+  printf("G[%d] = (BG: n=%lld (off=%*lld), m=%lld (n/N=%4.1f%%, m/M=%4.1f%%))\n",
+   k,
+   BG->n,
+   intlog(10,BG->n), BG->offset, BG->m,
+   100.0*BG->n/G->n, 100.0*BG->m/G->m);
+}
+
+static void write_bucket(void *arg, int k) {
+  struct onebyone_t *O = (struct onebyone_t *)arg;
+  struct graph_t *G = O->G;
+  erasure_pool_file(&O->list->pool[k], O->DF_B->file_info_list[k].fd, O->DF_B->file_info_list[k].fname);
+  dump_subgraph_mergingmode(&G->BG_list[k], G->num_graphs, O->G_full->num_graphs, k);
+  lfree(G->pool[k]);
+}
+
 
 I64_t *ne_onm;
 static I64_t *graph_construction_onebyone(struct edgelist_t *list, struct edgelist_t *list_full,
-                                          I64_t *num_edges, struct dumpfiles_t *DF_B) {
+                                          I64_t *num_edges, struct dumpfiles_t *DF_B, I64_t *degree) {
 
 
   assert( ne_onm = (I64_t *)calloc(list_full->num_lists, sizeof(I64_t)) );
@@ -366,48 +776,35 @@ static I64_t *graph_construction_onebyone(struct edgelist_t *list, struct edgeli
 
   printf("graph construction into NVM without self-loop and duplicated-edges ... \n");
 
-  degree_max = 0, degree_min = list->num_edges;
-  I64_t offset = 0;
-  const double s_time0 = get_seconds();
-  for (int k = 0; k < list->num_lists; k++) {
-    const double s_time1 = get_seconds();
-    printf("-- construct subgraph [%d] --\n", k);
-    allocate_subgraph(G, k);
-    count_node_degree(G, list, k);
-    printf("[elapsed: %6.2fs] finished: count each vertex degree\n", get_seconds()-s_time1);
-    parallel_prefix_sum(G, k);
-    printf("[elapsed: %6.2fs] finished: parallel prefix sum\n", get_seconds()-s_time1);
-    construct_subgraphs(G, list, k);
-    printf("[elapsed: %6.2fs] finished: construct sub-graphs\n", get_seconds()-s_time1);
-
-    printf("drop page cache, unmap pool and delete file for bucket edgelist\n");
-    erasure_pool_file(&list->pool[k], DF_B->file_info_list[k].fd, DF_B->file_info_list[k].fname);
-    dump_subgraph_with_merging_files(G, G_full, k, offset);
-    offset = G->BG_list[k].start[G->BG_list[k].n];
-    printf("[elapsed: %6.2fs] finished: dump sub-graphs\n", get_seconds()-s_time1);
-
-    struct subgraph_t *BG = &G->BG_list[k];
-    printf("G[%d] = (BG: n=%lld (off=%*lld), m=%lld (n/N=%4.1f%%, m/M=%4.1f%%))\n",
-     k,
-     BG->n,
-     intlog(10,BG->n), BG->offset, BG->m,
-     100.0*BG->n/G->n, 100.0*BG->m/G->m);
-
-    printf("free subgraph\n\n");
-    lfree(G->pool[k]);
+  /* the adjacency lists are sorted by the degrees counted while dividing edges */
+  assert( degree_table_code = (unsigned char *)calloc(G->n, sizeof(unsigned char)) );
+  const double s_time1 = get_seconds();
+  printf("updating degree table...\n");
+  update_degree_table(G, degree);
+  printf("done [elapsed: %6.2fs]\n\n", get_seconds()-s_time1);
 
-  }
+  const double s_time0 = get_seconds();
+  struct onebyone_t O = { G, G_full, list, DF_B, degree, 0 };
+  struct bucket_stage_t stage = { read_bucket, build_bucket, write_bucket, &O, -1, -1 };
+  run_bucket_pipeline(&stage, list->num_lists);
   printf("finished: construct all subgraphs [elapsed: %6.2fs]\n\n", get_seconds() - s_time0);
 
+  /* update # of edges */
+  G->m = 0;
+  for (int k = 0; k < G->num_graphs; ++k) {
+    G->m += G->BG_list[k].m;
+  }
 
-  for(int k = 0; k < G_full->num_graphs; k++)
-    ne_onm[k] = G->m;
-
-
-  printf("-- Extract duplicated edges --\n");
   const double s_time2 = get_seconds();
-  extract_duplicated_edges(G);
-  printf("finished: extracting duplicated edges [elapsed: %6.2fs]\n", get_seconds()-s_time2);
+  printf("updating degree table...\n");
+  update_degree_table(G, degree);
+  printf("done [elapsed: %6.2fs]\n\n", get_seconds()-s_time2);
+
+  /* dump degree */
+  dump_degree_distribution(G);
+  printf("free degree table\n");
+  free(degree_table_code);
+  free(degree);
 
 
   printf("G = {\n");
@@ -624,10 +1021,6 @@ static void allocate_subgraph(struct graph_t *G, int graph_no)
     if (id == 0) {
 
       for (j = BG->n; j > 0; --j) {
-        const I64_t dg = BG->start[j] = BG->start[j-1];
-        if (degree_max < dg) degree_max = dg;
-        if (degree_min > dg) degree_min = dg;
-
         BG->start[j] = BG->start[j-1];
       }
       BG->start[0] = 0;
@@ -655,68 +1048,57 @@ static void allocate_subgraph(struct graph_t *G, int graph_no)
 }
 
 
-static unsigned char *degree_table_code = NULL;
-
-static void update_degree_table(struct graph_t *G) {
-
-
-  struct dumpfiles_t *DF_s = init_dumpfile_info_graph("", 1, 1);
-  open_files(DF_s);
+/* ------------------------------------------------------------
+ * update_degree_table
+ *   encodes degree[] into degree_table_code[] and sums up the
+ *   on-memory edges of each NUMA node into ne_onm[].
+ * ------------------------------------------------------------ */
+static void update_degree_table(struct graph_t *G, const I64_t *degree) {
 
   const I64_t lower_limit = 1;
 
-  memset(degree_table_code, 0x00, G->n * sizeof(unsigned char));
+  I64_t max = 0, min = G->m;
+  OMP("omp parallel num_threads(get_numa_num_threads())") {
+    I64_t j, ls, le, maxdg = 0, mindg = G->m;
+    partial_range(G->n, 0, get_numa_num_threads(), omp_get_thread_num(), &ls, &le);
+    for (j = ls; j < le; ++j) {
+      if (maxdg < degree[j]) maxdg = degree[j];
+      if (mindg > degree[j]) mindg = degree[j];
+    }
+    OMP("omp critical")
+    if (max < maxdg) max = maxdg;
+    OMP("omp critical")
+    if (min > mindg) min = mindg;
+  }
+  degree_max = max, degree_min = min;
 
-  I64_t max = degree_max;
-  I64_t min = degree_min;
   I64_t chunk = ROUNDUP( ( max - min + 1) / (256LL-lower_limit-1LL), 2);
+  if (chunk < 1) chunk = 1;
   I64_t log_c = log2(chunk);
 
-  degree_max = 0, degree_min = G->m;
+  const int nodes = get_numa_online_nodes();
+  const int lgraphs = G->num_graphs / nodes;
+  for (int j = 0; j < nodes; j++) ne_onm[j] = 0;
 
   I64_t degree_sum = 0;
 
   OMP("omp parallel num_threads(get_numa_num_threads()) reduction(+:degree_sum)") {
     int id = omp_get_thread_num();
-    int nodeid = get_numa_nodeid(id);
-    int coreid = get_numa_vircoreid(id);
-    int lcores = get_numa_online_cores(nodeid);
-    int nodes = get_numa_online_nodes();
-    pinned(USE_HYBRID_AFFINITY, id);
-    OMP("omp barrier");
+    int threads = get_numa_num_threads();
 
-    int lgraphs = G->num_graphs / nodes;
-    I64_t mindg = G->m, maxdg = 0;
-    size_t base_offset = G->BG_list[lgraphs * nodeid].offset;
-    I64_t l_onmem_degree_sum = 0;
-    for (int k = 0; k < lgraphs; k++) {
-      int subgraph_no = lgraphs*nodeid + k;
-      struct subgraph_t *BG = &G->BG_list[subgraph_no];
-
-      if (coreid == 0) {
-        int fd = DF_s->file_info_list[nodeid].fd;
-        const I64_t range = BG->n;
-        size_t sz = (range+1) * sizeof(I64_t);
-        //sz = ROUNDUP( sz, hugepage_size() );
-        size_t chip_size;
-        G->pool[subgraph_no] = mmap_pool(sz, fd, (BG->offset - base_offset) * sizeof(I64_t), &chip_size);
-        BG->start = (I64_t *)&G->pool[subgraph_no].pool[chip_size];
-        int err = madvise((void *)G->pool[subgraph_no].pool, G->pool[subgraph_no].memsize, MADV_SEQUENTIAL);
-        if (err == -1) perror("madvice seaquential update_degree_table");
-      }
-      OMP("omp barrier");
+    for (int k = 0; k < G->num_graphs; k++) {
+      struct subgraph_t *BG = &G->BG_list[k];
+      I64_t l_onmem_degree_sum = 0;
 
       I64_t j, ls, le;
-      partial_range(BG->n, 0, lcores, coreid, &ls, &le);
+      partial_range(BG->n, BG->offset, threads, id, &ls, &le);
       for (j = ls; j < le; ++j) {
-        const I64_t bs = BG->start[j], be = BG->start[j+1], dg = be-bs, v = j+BG->offset;
+        const I64_t dg = degree[j];
 
-        if (dg <= lower_limit) degree_table_code[v] = dg;
-        else degree_table_code[v] = (dg >> log_c) + lower_limit + 1;
+        if (dg <= lower_limit) degree_table_code[j] = dg;
+        else degree_table_code[j] = (dg >> log_c) + lower_limit + 1;
 
         degree_sum += dg;
-        if (maxdg < dg) maxdg = dg;
-        if (mindg > dg) mindg = dg;
 
         if (dg >= baseline_fully_onmem_edges) {
           l_onmem_degree_sum += dg;
@@ -726,88 +1108,21 @@ static void update_degree_table(struct graph_t *G) {
           l_onmem_degree_sum += max_onmem_edges;
         }
       }
-      OMP("omp barrier");
-
-      if (coreid == 0) {
-        drop_pagecaches_pool(&G->pool[subgraph_no]);
-        unmap_pool(&G->pool[subgraph_no]);
-      }
-      OMP("omp barrier");
+      SYNC_FETCH_AND_ADD(&ne_onm[k / lgraphs], l_onmem_degree_sum);
     }
-
-    OMP("omp critical")
-    if (degree_max < maxdg) degree_max = maxdg;
-    OMP("omp critical")
-    if (degree_min > mindg) degree_min = mindg;
-    OMP("omp barrier");
-
-    if (id == 0)
-      for (int j=0; j < nodes; j++) ne_onm[j] = 0;
-        OMP("omp barrier");
-
-      SYNC_FETCH_AND_ADD(&ne_onm[nodeid], l_onmem_degree_sum);
-    }
-
-    printf("sum([d for d in degree_list]) is %lld (= #edges: %lld)\n", degree_sum, G->m);
-    printf("min([d for d in degree_list]) is %lld\n", degree_min);
-    printf("max([d for d in degree_list]) is %lld\n", degree_max);
-    assert( degree_sum == G->m );
-
-
-
-    close_files(DF_s);
-    free_files(DF_s);
-
   }
 
-  static int intdegreecmp(const void *a, const void *b) {
-    const I64_t _a = *(const I64_t *)a;
-    const I64_t _b = *(const I64_t *)b;
-    const unsigned char _ia = degree_table_code[_a];
-    const unsigned char _ib = degree_table_code[_b];
-#if 1
-  /* descending order */
-  /* Intel(R) Xeon(R) CPU E5-4640 2.40GHz */
-  /*    Kronecker SCALE=26, edgefactor=16 */
-    if (_ia > _ib) return -1;
-    if (_ia < _ib) return  1;
-    if ( _a >  _b) return -1;
-    if ( _a <  _b) return  1;
-#else
-  /* ascending order */
-  /* Intel(R) Xeon(R) CPU E5-4640 2.40GHz */
-  /*    Kronecker SCALE=26, edgefactor=16 */
-  if (_ia < _ib) return -1;
-  if (_ia > _ib) return  1;
-  if ( _a <  _b) return -1;
-  if ( _a >  _b) return  1;
-#endif
-  return 0;
+  printf("sum([d for d in degree_list]) is %lld (= #edges: %lld)\n", degree_sum, G->m);
+  printf("min([d for d in degree_list]) is %lld\n", degree_min);
+  printf("max([d for d in degree_list]) is %lld\n", degree_max);
+  assert( degree_sum == G->m );
+
 }
 
 static void sort_adjacency_list_by_degree(struct graph_t *G, int subgraph_no) {
-  I64_t duplicates = 0;
-
   const double t1 = get_seconds();
-  OMP("omp parallel num_threads(get_numa_num_threads()) reduction(+:duplicates)") {
-    int id = omp_get_thread_num();
-    int threads = get_numa_num_threads();
-    I64_t ls, le;
-    struct subgraph_t *BG = &G->BG_list[subgraph_no];
-    size_t offset = BG->start[0];
-    partial_range(BG->n, 0, threads, id, &ls, &le);
-    for (I64_t j = ls; j < le; ++j) {
-      I64_t bs = BG->start[j], be = BG->start[j+1], dg = be-bs;
-      if (dg) {
-        I64_t *array = &BG->end[bs - offset];
-        I64_t uniq_dg = uniq(array, dg, sizeof(I64_t), qsort, intdegreecmp);
-        for (I64_t i = uniq_dg; i < dg; ++i) array[i] = -1; /* filled -1 */
-        duplicates += dg - uniq_dg;
-      }
-    }
-
-    OMP("omp barrier");
-  }
+  const I64_t duplicates = sort_adjacency_lists_by_degree(&G->BG_list[subgraph_no], 1, 0,
+                                                          G->n, NULL, degree_table_code);
   const double t2 = get_seconds();
 
   printf("found %lld duplicated edges (%.3f %%) (%.3f seconds)\n",
@@ -816,181 +1131,6 @@ static void sort_adjacency_list_by_degree(struct graph_t *G, int subgraph_no) {
 
 
 
-static void load_subgraph(struct graph_t *G, int subgraph_no, I64_t n_offset, I64_t m_offset)
-{
-  int nodes = get_numa_online_nodes();
-  int lgraphs = G->num_graphs / nodes;
-  int target_graph = subgraph_no / lgraphs;
-
-  struct dumpfiles_t *DF_s = init_dumpfile_info_graph("", 1, 1);
-  open_files_readmode(DF_s);
-  struct dumpfiles_t *DF_e = init_dumpfile_info_graph("", 0, 1);
-  open_files_readmode(DF_e);
-
-
-  //printf("inputfile = %s\n", DF_s->file_info_list[target_graph].fname);
-  //printf("inputfile = %s\n", DF_e->file_info_list[target_graph].fname);
-
-  // I64_t n_offset = 0;
-  // I64_t m_offset = 0;
-  // for (int k = target_graph*lgraphs; k < subgraph_no; k++) {
-  //   n_offset += G->BG_list[k].n;
-  //   m_offset += G->BG_list[k].m;
-  // }
-
-  lseek(DF_s->file_info_list[target_graph].fd, n_offset * sizeof(I64_t), SEEK_SET);
-  read_large_size(DF_s->file_info_list[target_graph].fd,
-    G->BG_list[subgraph_no].start,
-    (G->BG_list[subgraph_no].n + 1) * sizeof(I64_t));
-#if 0
-  for (I64_t k = 0; k < G->BG_list[subgraph_no].n + 1; k++) {
-    fprintf(stderr, "%lld\n", G->BG_list[subgraph_no].start[k]);
-  }
-#endif
-
-
-
-  lseek(DF_e->file_info_list[target_graph].fd, m_offset * sizeof(I64_t), SEEK_SET);
-  read_large_size(DF_e->file_info_list[target_graph].fd,
-    G->BG_list[subgraph_no].end,
-    (G->BG_list[subgraph_no].m) * sizeof(I64_t));
-#if 0
-  for (I64_t k = 0; k < G->BG_list[subgraph_no].m; k++) {
-    printf("%lld\n", G->BG_list[subgraph_no].end[k]);
-  }
-#endif
-
-  close_files(DF_s);
-  close_files(DF_e);
-  free_files(DF_s);
-  free_files(DF_e);
-}
-
-static void write_subgraph(struct graph_t *G, int subgraph_no)
-{
-  int nodes = get_numa_online_nodes();
-  int lgraphs = G->num_graphs / nodes;
-  int target_graph = subgraph_no / lgraphs;
-
-  struct dumpfiles_t *DF_s = init_dumpfile_info_graph("", 1, 1);
-  open_files(DF_s);
-  struct dumpfiles_t *DF_e = init_dumpfile_info_graph("", 0, 1);
-  open_files(DF_e);
-
-
-  I64_t n_offset = 0;
-  I64_t m_offset = 0;
-  for (int k = target_graph*lgraphs; k < subgraph_no; k++) {
-    n_offset += G->BG_list[k].n;
-    m_offset += G->BG_list[k].m;
-  }
-
-  int is_last = (subgraph_no % lgraphs) == (lgraphs - 1);
-  size_t length = 0;
-  if (is_last) length = G->BG_list[subgraph_no].n+1;
-  else         length = G->BG_list[subgraph_no].n;
-  lseek(DF_s->file_info_list[target_graph].fd, n_offset * sizeof(I64_t), SEEK_SET);
-  write_large_size(DF_s->file_info_list[target_graph].fd,
-    G->BG_list[subgraph_no].start,
-    length * sizeof(I64_t));
-
-  lseek(DF_e->file_info_list[target_graph].fd, m_offset * sizeof(I64_t), SEEK_SET);
-  write_large_size(DF_e->file_info_list[target_graph].fd,
-    G->BG_list[subgraph_no].end,
-    (G->BG_list[subgraph_no].m) * sizeof(I64_t));
-
-  close_files(DF_s);
-  close_files(DF_e);
-  free_files(DF_s);
-  free_files(DF_e);
-
-}
-
-static void dump_degree_distribution(struct graph_t *G);
-
-static void extract_duplicated_edges(struct graph_t *G) {
-
-  assert( degree_table_code = (unsigned char *)calloc(G->n, sizeof(unsigned char)) );
-
-  const double s_time1 = get_seconds();
-  printf("updating degree table...\n");
-  update_degree_table(G);
-  printf("done [elapsed: %6.2fs]\n\n", get_seconds()-s_time1);
-
-
-  int nodes = get_numa_online_nodes();
-  int lgraphs = G->num_graphs / nodes;
-
-  I64_t local_n_offset = 0;
-  I64_t local_m_offset = 0;
-
-  size_t offset = 0;
-  for (int k = 0; k < G->num_graphs; k++) {
-    printf("-- extract duplicated edges for subgraph [%d] --\n", k);
-    allocate_subgraph(G, k);
-    load_subgraph(G, k, local_n_offset, local_m_offset);
-    struct subgraph_t *BG = &G->BG_list[k];
-    if ((k + 1) % lgraphs == 0) {
-      local_n_offset = 0;
-      local_m_offset = 0;
-    } else {
-      local_n_offset += BG->n;
-      local_m_offset += BG->m;
-    }
-    sort_adjacency_list_by_degree(G, k);
-
-    /* Backward Graph */
-    I64_t crr = 0;
-
-    I64_t ost = BG->start[0];
-    for (I64_t j = 0; j < BG->n; ++j) {
-      const I64_t ls = BG->start[j], le = BG->start[j+1];
-      BG->start[j] = crr + offset;
-      for (I64_t w = ls; w < le; ++w) {
-        I64_t v = BG->end[w - ost];
-        if (v != -1) {
-          BG->end[crr++] = v;
-        }
-      }
-    }
-    BG->start[BG->n] = crr + offset;
-    BG->m = crr;
-
-    if ((k + 1) % lgraphs == 0) {
-      offset = 0;
-    } else {
-      offset += crr;
-    }
-
-    write_subgraph(G, k);
-
-    lfree(G->pool[k]);
-
-  }
-
-  /* update # of edges */
-  G->m = 0;
-  for (int k = 0; k < G->num_graphs; ++k) {
-    G->m += G->BG_list[k].m;
-  }
-
-  const double s_time2 = get_seconds();
-  printf("updating degree table...\n");
-  update_degree_table(G);
-  printf("done [elapsed: %6.2fs]\n\n", get_seconds()-s_time2);
-
-
-  const double e_time = get_seconds();
-  printf("extract duplicated edges (#threads=1, %.3f seconds)\n", e_time - s_time1);
-
-  /* dump degree */
-  dump_degree_distribution(G);
-  printf("free degree table\n");
-  free(degree_table_code);
-
-}
-
-
 /* ------------------------------------------------------------
  * dump degree distribution
  * ------------------------------------------------------------ */
@@ -1064,37 +1204,16 @@ static void extract_duplicated_edges(struct graph_t *G) {
   }
 }
 
-static void dump_subgraph_with_merging_files(struct graph_t *G, struct graph_t *G_full,
-                                             int subgraph_no, I64_t offset){
-
-
+/* ------------------------------------------------------------
+ * merge_subgraph_info
+ *   counts a subgraph into G_full. it is stored into the merged files
+ *   by dump_subgraph_mergingmode.
+ * ------------------------------------------------------------ */
+static void merge_subgraph_info(struct graph_t *G, struct graph_t *G_full, int subgraph_no){
 
   int lgraphs = (G->num_graphs / G_full->num_graphs);
   int target_no = subgraph_no / lgraphs;
 
-
-  if (subgraph_no % lgraphs != 0) {
-    OMP("omp parallel num_threads(get_numa_num_threads())") {
-      int id = omp_get_thread_num();
-      int threads = get_numa_num_threads();
-      OMP("omp barrier");
-
-      I64_t ls, le;
-      struct subgraph_t *BG = &G->BG_list[subgraph_no];
-      partial_range(BG->n+1, 0, threads, id, &ls, &le);
-      for (I64_t i = ls; i < le; i++) {
-        BG->start[i] += offset;
-      }
-
-      clear_affinity();
-    }
-
-  }
-
-  dump_subgraph_mergingmode(&G->BG_list[subgraph_no],
-    G->num_graphs, G_full->num_graphs,
-    subgraph_no);
-
   if (subgraph_no == 0) {
     G_full->n = G->n;
     G_full->m = G->m;
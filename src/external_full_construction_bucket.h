@@ -36,4 +36,15 @@
  * For Ex-mem construction
  * ----------------------------- */
 I64_t *external_full_graph_construction(struct edgelist_t *list, struct dumpfiles_t *DF_E);
+
+/* -----------------------------
+ * edges streamed into buckets by the generator
+ * ----------------------------- */
+// open_edgebucket_stream creates the bucket files of list, the generator
+// threads pass their edges to append_edgebucket_stream and close flushes
+// the staged edges. the stream is then handed over by list->buckets.
+struct edgebucket_stream_t *open_edgebucket_stream(const struct edgelist_t *list);
+void append_edgebucket_stream(struct edgebucket_stream_t *S, int id,
+                              const struct packed_edge *E, I64_t n);
+void close_edgebucket_stream(struct edgebucket_stream_t *S);
 #endif // EXTERNAL_FULL_CONSTRUCTION_BUCKET_H
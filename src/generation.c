@@ -29,12 +29,14 @@
 #include <assert.h>
 
 #include "generation.h"
+#include "snapshot.h"
 
 
 /* ------------------------------------------------------------
  * graph_generation
  * ------------------------------------------------------------ */
-static struct edgelist_t *allocate_edgelist(int scale, int edgefactor, int num_lists, I64_t nbfs);
+static struct edgelist_t *allocate_edgelist_info(int scale, int edgefactor, int num_lists, I64_t nbfs);
+static struct edgelist_t *generate_kron_roots(int scale, int edgefactor, int num_lists, I64_t nbfs);
 static I64_t generate_kron_edges(int scale, int edgefactor, struct edgelist_t *list);
 static I64_t generate_rmat_edges(int scale, int edgefactor, struct edgelist_t *list);
 
@@ -42,9 +44,21 @@ struct edgelist_t *graph_generation(int scale, int edgefactor, int num_lists, I6
   struct edgelist_t *list = NULL;
   double t1, t2;
 
+  if ( getenvi((char *)ENV_REGENERATE_EDGES, 0) ) {
+    if (!use_RMAT_generator) {
+      return generate_kron_roots(scale, edgefactor, num_lists, nbfs);
+    }
+    printf("R-MAT edges cannot be regenerated, storing the edgelist\n");
+  }
+
+  const char *snapshot = getenv(ENV_SNAPSHOT);
+  if ( snapshot && (list = restore_edgelist_snapshot(snapshot, num_lists, nbfs)) ) {
+    return list;
+  }
+
   /* allocation */
   t1 = get_seconds();
-  assert( list = allocate_edgelist(scale, edgefactor, num_lists, nbfs) );
+  assert( list = allocate_edgelist_numa(scale, edgefactor, num_lists, nbfs) );
   t2 = get_seconds();
   printf("numa node local allocation takes %.3f seconds\n", t2-t1);
 
@@ -66,7 +80,7 @@ struct edgelist_t *graph_generation(int scale, int edgefactor, int num_lists, I6
 }
 
 
-static struct edgelist_t *allocate_edgelist(int scale, int edgefactor, int num_lists, I64_t nbfs) {
+static struct edgelist_t *allocate_edgelist_info(int scale, int edgefactor, int num_lists, I64_t nbfs) {
   struct edgelist_t *list = NULL;
   assert( list = (struct edgelist_t *)calloc(1, sizeof(struct edgelist_t)) );
 
@@ -89,6 +103,12 @@ static struct edgelist_t *allocate_edgelist(int scale, int edgefactor, int num_l
     list->IJ_list[k].length = list->IJ_list[k+1].offset - list->IJ_list[k].offset;
   }
   list->IJ_list[k].length = 0;
+  return list;
+}
+
+struct edgelist_t *allocate_edgelist_numa(int scale, int edgefactor, int num_lists, I64_t nbfs) {
+  struct edgelist_t *list = allocate_edgelist_info(scale, edgefactor, num_lists, nbfs);
+  int k;
 
   /* memory allocation */
   for (k = 0; k < num_lists; ++k) {
@@ -110,6 +130,35 @@ static struct edgelist_t *allocate_edgelist(int scale, int edgefactor, int num_l
   return list;
 }
 
+/* ------------------------------------------------------------
+ * generate_kron_roots
+ *   one streaming pass of the generator samples the roots; the
+ *   edges are dropped and regenerated later by regenerate_edges.
+ * ------------------------------------------------------------ */
+static struct edgelist_t *generate_kron_roots(int scale, int edgefactor, int num_lists, I64_t nbfs) {
+  const double t1 = get_seconds();
+  struct edgelist_t *list = allocate_edgelist_info(scale, edgefactor, num_lists, nbfs);
+  list->regenerate = 1;
+  make_edgelist_seed(list->seed);
+
+  I64_t generated = make_edgelist_stream(scale, edgefactor, num_lists, REGENERATE_CHUNK_EDGES,
+                                         NULL, NULL, &list->numsrcs, list->srcs);
+  assert( generated == list->num_edges );
+  const double t2 = get_seconds();
+  list->time = t2 - t1;
+
+  printf("[%s] drop %lld regenerable (i,j)-pairs"
+	 " (SCALE %d: n=%lld, m=%lld, %.3f seconds)\n", __FUNCTION__, generated,
+	 scale, list->num_nodes, list->num_edges, t2-t1);
+  printf("[%s] generate %lld BFS sources\n", __FUNCTION__, list->numsrcs);
+  return list;
+}
+
+void regenerate_edges(const struct edgelist_t *list, I64_t start, I64_t end, struct packed_edge *edges) {
+  assert( list->regenerate );
+  generate_kronecker_edges(0, list->seed, SCALE, start, end, edges);
+}
+
 static I64_t generate_kron_edges(int scale, int edgefactor, struct edgelist_t *list) {
 
   struct packed_edge **IJ_list
@@ -173,15 +222,29 @@ int dump_edgelist(const char *filename, struct edgelist_t *list) {
     return 1;
   } else {
     int k;
+    struct packed_edge *E = NULL;
+    assert( E = (struct packed_edge *)malloc(REGENERATE_CHUNK_EDGES * sizeof(struct packed_edge)) );
     fprintf(fp, "p sp %lld %lld\n", list->num_nodes, list->num_edges);
     for (k = 0; k < list->num_lists; ++k) {
       I64_t e;
       for (e = 0; e < list->IJ_list[k].length; ++e) {
-	const I64_t v = get_v0_from_edge(&list->IJ_list[k].edges[e]);
-	const I64_t w = get_v1_from_edge(&list->IJ_list[k].edges[e]);
+	const struct packed_edge *IJ = NULL;
+	if (list->regenerate) {
+	  const I64_t pos = e % REGENERATE_CHUNK_EDGES;
+	  if (pos == 0) {
+	    const I64_t s = list->IJ_list[k].offset + e, n = list->IJ_list[k].length - e;
+	    regenerate_edges(list, s, s + (n < (I64_t)REGENERATE_CHUNK_EDGES ? n : (I64_t)REGENERATE_CHUNK_EDGES), E);
+	  }
+	  IJ = &E[pos];
+	} else {
+	  IJ = &list->IJ_list[k].edges[e];
+	}
+	const I64_t v = get_v0_from_edge(IJ);
+	const I64_t w = get_v1_from_edge(IJ);
 	fprintf(fp, "a %lld %lld 1\n", v+1, w+1);
       }
     }
+    free(E);
     fclose(fp);
     return 0;
   }
@@ -198,6 +261,7 @@ void free_edgelist(struct edgelist_t *list) {
   for (k = 0; k < list->num_lists; ++k) {
     lfree(list->pool[k]);
   }
+  detach_snapshot(&list->shared);
   free(list->IJ_list);
   free(list->pool);
   free(list->srcs);
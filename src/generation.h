@@ -32,6 +32,14 @@ struct IJ_list_t {
   struct packed_edge *edges;
 };
 
+struct edgebucket_stream_t;
+
+/* REGENERATE_EDGES=1 (Kronecker) stores no edgelist: generation only
+   samples the roots, and construction (graph500) and validation (all
+   binaries) regenerate the edges in chunks of REGENERATE_CHUNK_EDGES. */
+#define ENV_REGENERATE_EDGES    "REGENERATE_EDGES"
+#define REGENERATE_CHUNK_EDGES  (1ULL << 12)
+
 struct edgelist_t {
   /* edgelist */
   I64_t num_nodes;
@@ -44,9 +52,19 @@ struct edgelist_t {
   I64_t numsrcs;
   I64_t *srcs;
   struct mempool_t *pool;
+  struct mempool_t shared;  /* attached read-only snapshot, if any */
+
+  /* edges already divided into construction buckets by the generator (exmem) */
+  struct edgebucket_stream_t *buckets;
+
+  /* regenerated edgelist: edges are NULL and regenerated from seed */
+  int regenerate;
+  uint_fast32_t seed[5];
 };
 
 extern struct edgelist_t *graph_generation(int scale, int edgefactor, int num_lists, I64_t nbfs);
+extern struct edgelist_t *allocate_edgelist_numa(int scale, int edgefactor, int num_lists, I64_t nbfs);
+extern void regenerate_edges(const struct edgelist_t *list, I64_t start, I64_t end, struct packed_edge *edges);
 extern int dump_edgelist(const char *filename, struct edgelist_t *list);
 extern void free_edgelist(struct edgelist_t *list);
 
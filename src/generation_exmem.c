@@ -37,23 +37,38 @@
 #include <string.h>
 #include <math.h>
 #include <assert.h>
+#include <unistd.h>
 
 #include "generation.h"
 #include "dump.h"
+#include "external_full_construction_bucket.h"
 
 
 /* ------------------------------------------------------------
  * graph_generation
  * ------------------------------------------------------------ */
+static struct edgelist_t *allocate_edgelist_info(int scale, int edgefactor, int num_lists, I64_t nbfs);
 static struct edgelist_t *allocate_edgelist_mmap(int scale, int edgefactor, int num_lists, I64_t nbfs,
                                                  struct dumpfiles_t *DF_E);
 static I64_t generate_kron_edges(int scale, int edgefactor, struct edgelist_t *list);
 static I64_t generate_rmat_edges(int scale, int edgefactor, struct edgelist_t *list);
+#if STREAM_EDGE_BUCKETS == 1
+static struct edgelist_t *graph_generation_stream(int scale, int edgefactor, int num_lists, I64_t nbfs);
+#endif
 
 struct edgelist_t *graph_generation(int scale, int edgefactor, int num_lists, I64_t nbfs) {
   struct edgelist_t *list = NULL;
   double t1, t2;
 
+#if STREAM_EDGE_BUCKETS == 1
+  if (!use_RMAT_generator) {
+    return graph_generation_stream(scale, edgefactor, num_lists, nbfs);
+  }
+#endif
+  if ( getenvi((char *)ENV_REGENERATE_EDGES, 0) ) {
+    printf("edges are read back by construction, storing the edgelist\n");
+  }
+
   /* initialize and open files for mmap*/
   struct dumpfiles_t *DF_E = NULL;
   DF_E = init_dumpfile_info_edgelist("", 0);
@@ -98,8 +113,7 @@ struct edgelist_t *graph_generation(int scale, int edgefactor, int num_lists, I6
   return list;
 }
 
-static struct edgelist_t *allocate_edgelist_mmap(int scale, int edgefactor, int num_lists, I64_t nbfs,
-                                                 struct dumpfiles_t *DF_E) {
+static struct edgelist_t *allocate_edgelist_info(int scale, int edgefactor, int num_lists, I64_t nbfs) {
   struct edgelist_t *list = NULL;
   assert( list = (struct edgelist_t *)calloc(1, sizeof(struct edgelist_t)) );
 
@@ -123,7 +137,15 @@ static struct edgelist_t *allocate_edgelist_mmap(int scale, int edgefactor, int
   }
   list->IJ_list[k].length = 0;
 
+  return list;
+}
+
+static struct edgelist_t *allocate_edgelist_mmap(int scale, int edgefactor, int num_lists, I64_t nbfs,
+                                                 struct dumpfiles_t *DF_E) {
+  struct edgelist_t *list = allocate_edgelist_info(scale, edgefactor, num_lists, nbfs);
+
   /* mmap */
+  int k;
   for (k = 0; k < num_lists; ++k) {
     struct IJ_list_t *IJ_list = list->IJ_list;
     size_t sz = 0;
@@ -148,6 +170,139 @@ static struct edgelist_t *allocate_edgelist_mmap(int scale, int edgefactor, int
 }
 
 
+#if STREAM_EDGE_BUCKETS == 1
+/* ------------------------------------------------------------
+ * graph_generation_stream
+ *   generator threads append each chunk of edges to the construction
+ *   buckets, so construction does not read the edge list back, and
+ *   hand a copy to the I/O worker of their node, which writes it to
+ *   the EDGELIST file (for validation) in the background. a thread
+ *   has EDGELIST_WRITE_BUFFERS copies in flight and waits for the
+ *   oldest before reusing it. with REGENERATE_EDGES=1 no EDGELIST
+ *   file is written; validation regenerates the edges.
+ * ------------------------------------------------------------ */
+#define EDGELIST_WRITE_BUFFERS 2
+
+struct edgelist_write_t {
+  struct io_job_t job;      /* must be the first member */
+  int posted;
+  const struct file_info_t *fi;
+  struct packed_edge *buf;  /* [STREAM_CHUNK_EDGES] */
+  I64_t pos, n;
+};
+
+struct stream_target_t {
+  struct dumpfiles_t *DF_E;
+  struct edgebucket_stream_t *S;
+  struct io_workers_t *IO;      /* a queue for each node's EDGELIST file */
+  struct edgelist_write_t *J;   /* [thread][EDGELIST_WRITE_BUFFERS] */
+  I64_t *turn;                  /* [thread] #posted writes */
+};
+
+static void write_edgelist_job(struct io_job_t *job) {
+  struct edgelist_write_t *J = (struct edgelist_write_t *)job;
+  const size_t len = J->n * sizeof(struct packed_edge);
+  if (pwrite_file(J->fi, J->buf, len, J->pos * sizeof(struct packed_edge)) != len) {
+    fprintf(stderr, "[error] write_edgelist_job: %s, pos=%lld, n=%lld\n",
+            J->fi->fname, J->pos, J->n);
+    exit(1);
+  }
+}
+
+static void emit_edges(void *arg, int id, int nodeid, I64_t pos,
+                       const struct packed_edge *E, I64_t n) {
+  struct stream_target_t *T = (struct stream_target_t *)arg;
+  if (T->IO) {
+    struct edgelist_write_t *J = &T->J[id * EDGELIST_WRITE_BUFFERS + T->turn[id]++ % EDGELIST_WRITE_BUFFERS];
+    if (J->posted) wait_io_job(&J->job);
+    memcpy(J->buf, E, n * sizeof(struct packed_edge));
+    J->fi  = &T->DF_E->file_info_list[nodeid];
+    J->pos = pos;
+    J->n   = n;
+    J->job.func = write_edgelist_job;
+    J->posted = 1;
+    post_io_job(T->IO, nodeid, &J->job);
+  }
+  append_edgebucket_stream(T->S, id, E, n);
+}
+
+static struct edgelist_t *graph_generation_stream(int scale, int edgefactor, int num_lists, I64_t nbfs) {
+  struct edgelist_t *list = NULL;
+  double t1, t2;
+
+  assert( list = allocate_edgelist_info(scale, edgefactor, num_lists, nbfs) );
+  if ( getenvi((char *)ENV_REGENERATE_EDGES, 0) ) {
+    list->regenerate = 1;
+    make_edgelist_seed(list->seed);
+  }
+
+  struct stream_target_t T;
+  memset(&T, 0x00, sizeof(struct stream_target_t));
+  const int threads = get_numa_num_threads();
+  if (!list->regenerate) {
+    T.DF_E = init_dumpfile_info_edgelist("", 1);
+    open_files_new(T.DF_E);
+    T.IO = start_io_workers(list->num_lists, 1);
+    assert( T.J    = (struct edgelist_write_t *)calloc(threads * EDGELIST_WRITE_BUFFERS, sizeof(struct edgelist_write_t)) );
+    assert( T.turn = (I64_t *)calloc(threads, sizeof(I64_t)) );
+    for (int i = 0; i < threads * EDGELIST_WRITE_BUFFERS; ++i) {
+      assert( T.J[i].buf = (struct packed_edge *)malloc(STREAM_CHUNK_EDGES * sizeof(struct packed_edge)) );
+    }
+  }
+  T.S = open_edgebucket_stream(list);
+
+  /* generation */
+  t1 = get_seconds();
+  I64_t generated = 0;
+  assert( generated = make_edgelist_stream(scale, edgefactor, list->num_lists, STREAM_CHUNK_EDGES,
+                                           emit_edges, &T, &list->numsrcs, list->srcs) );
+  assert( generated == list->num_edges );
+  if (T.IO) {
+    for (int i = 0; i < threads * EDGELIST_WRITE_BUFFERS; ++i) {
+      if (T.J[i].posted) wait_io_job(&T.J[i].job);
+      free(T.J[i].buf);
+    }
+    stop_io_workers(T.IO);
+    free(T.J);
+    free(T.turn);
+  }
+  close_edgebucket_stream(T.S);
+  list->buckets = T.S;
+  t2 = get_seconds();
+  list->time = t2 - t1;
+  printf("[%s] generate undirected %lld (i,j)-pairs into edge buckets"
+         " (SCALE %d: n=%lld, m=%lld)\n", __FUNCTION__, generated,
+         scale, list->num_nodes, list->num_edges);
+  printf("[%s] generate %lld BFS sources\n", __FUNCTION__, list->numsrcs);
+  printf("kronecker graph generation takes %.3f seconds\n", t2-t1);
+
+#if STORE_BFS_SOURCES == 1
+  dump_srcs_fwrite(list);
+#endif
+
+  if (list->regenerate) {
+    printf("no edgelist is stored (regenerated by validation)\n");
+    return list;
+  }
+
+  /* the same file size as the mmap'ed edge list */
+  printf("drop page caches for edgelist\n");
+  int k;
+  for (k = 0; k < list->num_lists; ++k) {
+    const size_t sz = ROUNDUP(list->IJ_list[k].length * sizeof(struct packed_edge), hugepage_size());
+    if (ftruncate(T.DF_E->file_info_list[k].fd, sz) != 0) {
+      perror("ftruncate at graph_generation_stream");
+    }
+    drop_pagecache_file_info(&T.DF_E->file_info_list[k]);
+  }
+  close_files(T.DF_E);
+  free_files(T.DF_E);
+
+  return list;
+}
+#endif
+
+
 //static struct edgelist_t *allocate_edgelist(int scale, int edgefactor, int num_lists, I64_t nbfs) {
 //  struct edgelist_t *list = NULL;
 //  assert( list = (struct edgelist_t *)calloc(1, sizeof(struct edgelist_t)) );
@@ -246,6 +401,17 @@ static I64_t generate_rmat_edges(int scale, int edgefactor, struct edgelist_t *l
 
 
 
+/* ------------------------------------------------------------
+ * regenerate edges (validation with REGENERATE_EDGES=1)
+ * ------------------------------------------------------------ */
+void regenerate_edges(const struct edgelist_t *list, I64_t start, I64_t end, struct packed_edge *edges) {
+  assert( list->regenerate );
+  generate_kronecker_edges(0, list->seed, SCALE, start, end, edges);
+}
+
+
+
+
 /* ------------------------------------------------------------
  * dump edgelist
  * ------------------------------------------------------------ */
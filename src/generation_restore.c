@@ -53,6 +53,12 @@ struct edgelist_t *graph_generation(int scale, int edgefactor, int num_lists, I6
 
     printf("No kronecker graph generation\n");
 
+    /* no EDGELIST files: validation regenerates the edges from the seed */
+    if ( getenvi((char *)ENV_REGENERATE_EDGES, 0) && !use_RMAT_generator ) {
+        list->regenerate = 1;
+        make_edgelist_seed(list->seed);
+    }
+
     read_srcs_fread(list);
     printf("read srcs done.\n");
 
@@ -90,6 +96,17 @@ static struct edgelist_t *allocate_edgelist_info(int scale, int edgefactor, int
 }
 
 
+/* ------------------------------------------------------------
+ * regenerate edges (validation with REGENERATE_EDGES=1)
+ * ------------------------------------------------------------ */
+void regenerate_edges(const struct edgelist_t *list, I64_t start, I64_t end, struct packed_edge *edges) {
+    assert( list->regenerate );
+    generate_kronecker_edges(0, list->seed, SCALE, start, end, edges);
+}
+
+
+
+
 /* ------------------------------------------------------------
  * dump edgelist
  * ------------------------------------------------------------ */
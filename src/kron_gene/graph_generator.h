@@ -90,6 +90,15 @@ extern "C" {
   I64_t make_edgelist(int scale, int edgefactor,
 		      int num_lists, struct packed_edge **edge_list,
 		      I64_t *nbfs_ptr, I64_t *bfs_root_ptr);
+
+  /* receives edges [pos, pos+n) of edge list nodeid, generated by thread id */
+  typedef void (*edge_emitter_t)(void *arg, int id, int nodeid, I64_t pos,
+				 const struct packed_edge *edges, I64_t n);
+  I64_t make_edgelist_stream(int scale, int edgefactor, int num_lists, I64_t chunk_edges,
+			     edge_emitter_t emit, void *arg,
+			     I64_t *nbfs_ptr, I64_t *bfs_root_ptr);
+  /* seed of generate_kronecker_edges for regenerating the edges of make_edgelist */
+  void make_edgelist_seed(uint_fast32_t seed[5]);
   I64_t rmat_edgelist(int scale, int edgefactor,
 		      int num_lists, struct packed_edge **edge_list,
 		      double A, double B, double C,
@@ -31,6 +31,8 @@ static void partial_edge_range(I64_t size, I64_t offset, I64_t np, I64_t id,
   *loop_end   = qt * (id+1) + (id+1 < rm ? id+1 : rm) + offset;
 }
 
+static I64_t sample_bfs_roots(int64_t N, const int *has_adj, I64_t *nbfs_ptr, I64_t *bfs_root_ptr);
+
 I64_t make_edgelist(int scale, int edgefactor,
 		    int num_lists, struct packed_edge **edge_list,
 		    I64_t *nbfs_ptr, I64_t *bfs_root_ptr) {
@@ -113,6 +115,90 @@ I64_t make_edgelist(int scale, int edgefactor,
     clear_affinity();
   }
   
+  sample_bfs_roots(N, has_adj, nbfs_ptr, bfs_root_ptr);
+  free(has_adj);
+  
+  return actual_edges;
+}
+
+/* --------------------------------------------------------------------------- */
+/* streaming generator                                                         */
+/*   the same edges as make_edgelist, but each thread generates its range in   */
+/*   chunks of chunk_edges edges into a private buffer and passes them to emit */
+/*   instead of storing the whole edge list. emit may be NULL (roots only).    */
+/* --------------------------------------------------------------------------- */
+I64_t make_edgelist_stream(int scale, int edgefactor, int num_lists, I64_t chunk_edges,
+			   edge_emitter_t emit, void *arg,
+			   I64_t *nbfs_ptr, I64_t *bfs_root_ptr) {
+  int64_t N = 1LL << scale, M = N * edgefactor;
+  int64_t actual_edges = 0;
+  
+  assert(M >= N);
+  assert(M >= edgefactor);
+  assert(chunk_edges > 0);
+  
+  init_random();
+  uint_fast32_t seed[5];
+  make_mrg_seed(userseed, userseed, seed);
+
+  int *has_adj = NULL;
+  assert( has_adj = (int *)calloc(N, sizeof(int)) );
+
+  double t1, t2;
+  
+  t1 = get_msecs() * 1e-3;
+  printf("generating kronecker edge list (streaming %lld edges per chunk) ...\n", chunk_edges);
+  OMP("omp parallel num_threads(get_numa_num_threads()) reduction(+:actual_edges)") {
+    int id = omp_get_thread_num();
+    int nodeid = get_numa_nodeid(id);
+    int coreid = get_numa_vircoreid(id);
+    int lcores = get_numa_online_cores(nodeid);
+    pinned(USE_HYBRID_AFFINITY, id);
+    I64_t node_start, node_end, thread_start, thread_end;
+    partial_edge_range(M, 0, num_lists, nodeid, &node_start, &node_end);
+    partial_edge_range(node_end-node_start, 0, lcores, coreid, &thread_start, &thread_end);
+
+    struct packed_edge *E = NULL;
+    assert( E = (struct packed_edge *)malloc(chunk_edges * sizeof(struct packed_edge)) );
+    I64_t pos, k;
+    for (pos = thread_start; pos < thread_end; pos += chunk_edges) {
+      const I64_t n = (thread_end - pos < chunk_edges) ? thread_end - pos : chunk_edges;
+      actual_edges += generate_kronecker_edges(id == 0 && pos == thread_start, seed, scale,
+					       pos+node_start, pos+node_start+n, E);
+      for (k = 0; k < n; ++k) {
+	const int64_t i = get_v0_from_edge(&E[k]);
+	const int64_t j = get_v1_from_edge(&E[k]);
+	if (i != j) {
+	  has_adj[i] = has_adj[j] = 1;
+	}
+      }
+      if (emit) emit(arg, id, nodeid, pos, E, n);
+    }
+    free(E);
+    clear_affinity();
+  }
+  t2 = get_msecs() * 1e-3;
+  printf("done. (generated %ld edges) (%.2f seconds)\n", (long)actual_edges, t2-t1);
+  assert(actual_edges == M);
+
+  sample_bfs_roots(N, has_adj, nbfs_ptr, bfs_root_ptr);
+  free(has_adj);
+  
+  return actual_edges;
+}
+
+/* --------------------------------------------------------------------------- */
+/* regeneration seed                                                           */
+/*   the generator is counter-based (each edge skips the MRG to its index), so */
+/*   generate_kronecker_edges(0, seed, scale, start, end, edges) regenerates   */
+/*   the edges [start, end) of make_edgelist exactly.                          */
+/* --------------------------------------------------------------------------- */
+void make_edgelist_seed(uint_fast32_t seed[5]) {
+  init_random();
+  make_mrg_seed(userseed, userseed, seed);
+}
+
+static I64_t sample_bfs_roots(int64_t N, const int *has_adj, I64_t *nbfs_ptr, I64_t *bfs_root_ptr) {
   /* Sample from {0, ..., N-1} without replacement. */
   int64_t NBFS = NBFS_max;
   int64_t k = 0, v = 0;
@@ -125,7 +211,6 @@ I64_t make_edgelist(int scale, int edgefactor,
       bfs_root_ptr[k++] = v++;
     }
   }
-  free(has_adj);
 
   /* verification */
   if ( N <= v && k < NBFS ) {
@@ -141,5 +226,5 @@ I64_t make_edgelist(int scale, int edgefactor,
   
   *nbfs_ptr = NBFS;
   
-  return actual_edges;
+  return NBFS;
 }
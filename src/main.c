@@ -98,6 +98,10 @@ void print_usage(FILE *stream) {
 	    "  DUMP_DEGREE=FILE\t\t   dumping degree distribution\n"
 	    "  DUMPEDGE=FILE\t\t\t   dumping edgelist (ID: 1,...,n)\n"
 	    "  DUMPGRAPH=FILE\t\t   dumping graph (ID: 1,...,n)\n"
+	    "  SNAPSHOT=FILE\t\t\t   restoring/saving binary graph snapshot (graph500 only)\n"
+	    "  SNAPSHOT_EDGELIST=0\t\t   saving snapshot without edgelist (regenerated on restore)\n"
+	    "  SNAPSHOT_VERIFY=1\t\t   checksumming attached snapshot (tmpfs, hugetlbfs)\n"
+	    "  REGENERATE_EDGES=1\t\t   regenerating edges instead of storing edgelist\n"
 	    "  ENERGY_LOOP_LIMIT=SECONDS\t   time limit of energy loops\n"
 	    "  PARAMRANGE=As:Ae:Bs:Be\t   alpha=[2^{As},2^{Ae}], beta=[2^{Bs},2^{Be}] for parameter tuning mode\n");
   }
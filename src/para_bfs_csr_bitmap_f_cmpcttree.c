@@ -53,6 +53,70 @@
 double current_seconds    = 0.0;
 double current_trav_edges = 0.0;
 
+/* max gap (#edges) merged into a single external read */
+static I64_t coalesce_gap = COALESCE_GAP / sizeof(I64_t);
+
+/* adaptive external reads (#edges): a bottom-up scan reads the first
+   read_length_bu edges of a tail and doubles the next read up to
+   read_length_max while it misses. a top-down scan reads whole tails. */
+static I64_t read_length_bu  = READ_LENGTH_BU;
+static I64_t read_length_max = READ_LENGTH_BU;
+
+#if PLACEMENT_PROFILE == 1
+/* #edges read from external memory for each vertex */
+static I64_t *exmem_access[MAX_NODES];
+#endif
+
+#if IO_WORKER_BFS == 1
+/* I/O workers reading external tails (a queue for each NUMA node's graph file) */
+static struct io_workers_t *io_workers = NULL;
+#endif
+
+/* deferred external-tail requests of a BFS thread */
+struct exmem_batch_t {
+#if IO_WORKER_BFS == 1
+  struct io_job_t job;      /* must be the first member */
+  int posted;
+#endif
+  const struct file_info_t *fi_start, *fi_end;
+  struct direct_cache_t *C_s, *C_e;
+  struct direct_cache_t cache_s, cache_e;
+  I64_t *buf;
+  I64_t buf_length;
+  I64_t offset;
+  I64_t max_len;            /* #edges of each tail read by fetch_exmem_batch */
+  I64_t nreq;
+  I64_t nfetched;           /* ext[0..nfetched) are in buf */
+  const I64_t *layout;      /* tail position in the layout file, or NULL */
+#if PLACEMENT_PROFILE == 1
+  I64_t *access;
+#endif
+  I64_t req_v[COALESCE_MAX_REQUESTS];
+  I64_t req_skip[COALESCE_MAX_REQUESTS];
+  I64_t req_end[COALESCE_MAX_REQUESTS];
+  I64_t cold[3*COALESCE_MAX_REQUESTS];   /* cold tails of fetch_exmem_tails with a layout */
+  struct read_extent_t ext[COALESCE_MAX_REQUESTS];
+};
+
+#if PREFETCH_NEXT_LEVEL == 1
+/* I/O workers of the next-level read-ahead, apart from io_workers so
+   that a long walk never delays the batches of the scan */
+static struct io_workers_t *prefetch_workers = NULL;
+
+/* next-level read-ahead of a BFS thread */
+struct prefetch_job_t {
+  struct io_job_t job;      /* must be the first member */
+  int posted;
+  const UL_t *bits;
+  int is_negated;
+  I64_t ls, le;
+  const I64_t *BG_start;
+  const UL_t *sig;          /* tail signatures, or NULL */
+  UL_t blocks;              /* blocks the next scan looks for */
+  struct exmem_batch_t B;   /* requests and CSR-index buffer of the job */
+};
+#endif
+
 const char *version(void) {
   return VERSION " (single,bitmap,offload,nntree)";
 }
@@ -62,6 +126,25 @@ static void prefetching_bfs_variables(struct graph_t *G, struct bfs_t *BFS);
 static I64_t make_local_bfs_tree(struct graph_t *G, struct bfs_t *BFS, I64_t s, I64_t *thresholds,
                                  struct dumpfiles_t *DF_FG_s, struct dumpfiles_t *DF_FG_e,
                                  struct dump_buffer_t *BF);
+static I64_t fetch_exmem_tails(const struct file_info_t *fi_start, struct direct_cache_t *C_s, I64_t *buf, I64_t buf_length,
+                               I64_t offset, const I64_t *layout, I64_t *req_v, I64_t *req_skip, I64_t *req_end,
+                               I64_t *cold, struct read_extent_t *ext, I64_t nreq, I64_t max_len);
+static void init_exmem_batch(struct exmem_batch_t *B, const struct file_info_t *fi_start,
+                             const struct file_info_t *fi_end, void *buf, I64_t buf_length, I64_t offset);
+static void fetch_exmem_batch(struct exmem_batch_t *B);
+#if IO_WORKER_BFS == 1
+static struct exmem_batch_t *post_exmem_batch(struct exmem_batch_t *batch, struct exmem_batch_t *B, int nodeid);
+#endif
+static void scan_exmem_batch_topdown(struct bfs_t *BFS, I64_t log_c, struct exmem_batch_t *B, I64_t buf_read_length,
+                                     I64_t *ptop_edges, I64_t *queue_count, I64_t *scanned_edges);
+static void scan_exmem_batch_bottomup(struct exmem_batch_t *B, I64_t max_read_length,
+                                      const UL_t *frontier, I64_t *tree, UL_t *visited, UL_t *neighbors,
+                                      I64_t *queue_count, I64_t *scanned_edges);
+static void probe_read_lengths(const struct file_info_t *fi_end, I64_t *buf, I64_t buf_length);
+#if PREFETCH_NEXT_LEVEL == 1
+static void prefetch_exmem_round(struct exmem_batch_t *B);
+static void prefetch_exmem_tails(struct io_job_t *job);
+#endif
 
 
 struct bfs_info_t {
@@ -94,13 +177,71 @@ struct stat_t *parallel_breadth_first_search(struct graph_t *G, struct edgelist_
 
   /* allocate and init file discripter */
   struct dumpfiles_t *DF_s = init_dumpfile_info_graph("", 1, 0);
+#if COMPRESS_GRAPH_END == 1
+  printf("[Compressed end files BFS]\n");
+  struct dumpfiles_t *DF_e = init_dumpfile_info_graph_compressed(0);
+#elif LAYOUT_GRAPH_TAILS == 1
+  printf("[Relaid external tails BFS]\n");
+  struct dumpfiles_t *DF_e = init_dumpfile_info_graph(LAYOUT_SUFFIX_DATA, 0, 0);
+#else
   struct dumpfiles_t *DF_e = init_dumpfile_info_graph("", 0, 0);
+#endif
+#if DIRECT_IO_BFS == 1
+  printf("[Direct I/O BFS]\n");
+  open_files_direct_readmode(DF_s);
+  open_files_direct_readmode(DF_e);
+#else
   open_files_readmode(DF_s);
   open_files_readmode(DF_e);
+#endif
+  const int farmem_nodeid = get_farmem_nodeid();
+  if (farmem_nodeid >= 0) {
+    printf("[Far-memory BFS]\n");
+    load_files_farmem(DF_s, farmem_nodeid);
+    load_files_farmem(DF_e, farmem_nodeid);
+  }
 
   /* allocate buffer for read BG */
   struct dump_buffer_t *BF = alloc_dump_buffer(DF_e->num_files);
 
+#if IO_WORKER_BFS == 1
+  /* I/O workers */
+  const int io_threads = getenvi((char *)ENV_IO_THREADS_PER_DEVICE, IO_THREADS_PER_DEVICE);
+  io_workers = start_io_workers(G->num_graphs, io_threads);
+  printf("[I/O worker BFS] %d threads x %d devices, %d batches per thread\n",
+         io_workers->queues[0].num_workers, io_workers->num_queues, (int)IO_BATCHES_PER_THREAD);
+#endif
+#if PREFETCH_NEXT_LEVEL == 1
+  /* I/O workers of the next-level read-ahead */
+  prefetch_workers = start_io_workers(G->num_graphs, getenvi((char *)ENV_IO_THREADS_PER_DEVICE, IO_THREADS_PER_DEVICE));
+  printf("[Next-level read-ahead] %d threads x %d devices\n",
+         prefetch_workers->queues[0].num_workers, prefetch_workers->num_queues);
+#endif
+
+  /* gap threshold for coalesced reads */
+  coalesce_gap = getenvi((char *)ENV_COALESCE_GAP, COALESCE_GAP);
+  if (coalesce_gap >= 0) coalesce_gap /= sizeof(I64_t);
+  printf("coalesced external reads: max gap %lld edges\n", coalesce_gap);
+
+  /* read lengths of the external tails */
+  read_length_bu  = getenvi((char *)ENV_READ_LENGTH_BU,  0);
+  read_length_max = getenvi((char *)ENV_READ_LENGTH_MAX, 0);
+#if READ_LENGTH_PROBE == 1
+  if (read_length_bu <= 0 || read_length_max <= 0) {
+    probe_read_lengths(&DF_e->file_info_list[0], BF->buffer_list[0].buf, BF->buffer_list[0].length);
+  }
+#endif
+  if (read_length_bu  <= 0) read_length_bu  = READ_LENGTH_BU;
+  if (read_length_max <= 0) read_length_max = MAX(read_length_bu, (I64_t)DUMP_BUF_LENGTH);
+  if (read_length_max < read_length_bu) read_length_max = read_length_bu;
+  printf("adaptive external reads: bottom-up %lld to %lld edges, top-down whole tails\n",
+         read_length_bu, read_length_max);
+
+#if PLACEMENT_PROFILE == 1
+  for (k = 0; k < G->num_graphs; ++k) {
+    assert( exmem_access[k] = (I64_t *)calloc(G->BG_list[k].n+1, sizeof(I64_t)) );
+  }
+#endif
 
   /* energy_loop */
   if ( enable_energy_loop ) {
@@ -156,11 +297,13 @@ struct stat_t *parallel_breadth_first_search(struct graph_t *G, struct edgelist_
         assert( tuning = (struct stat_t *)calloc(list->numsrcs, sizeof(struct stat_t)) );
         for (k = 0; k < list->numsrcs; ++k) {
 
+#if DIRECT_IO_BFS == 0
           // -- drop pagacache !!!CORE MAJOR ONLY -- //
           for (int id = 0; id < G->num_graphs; id++) {
             drop_pagecache_file(DF_s->file_info_list[id].fname);
-            drop_pagecache_file(DF_e->file_info_list[id].fname);
+            drop_pagecache_file_info(&DF_e->file_info_list[id]);
           }
+#endif
 
           prefetching_bfs_variables(G, BFS);
           tuning[k].bfs_time = get_seconds();
@@ -260,6 +403,13 @@ struct stat_t *parallel_breadth_first_search(struct graph_t *G, struct edgelist_
            (double)stat[k].trav_edges/stat[k].bfs_time);
   }
 
+#if PLACEMENT_PROFILE == 1
+  dump_placement_profile(exmem_access, G);
+  for (k = 0; k < G->num_graphs; ++k) {
+    free(exmem_access[k]);
+  }
+#endif
+
   /* free */
   for (k = 0; k < BFS->num_locals; ++k) {
     lfree(BFS->pool[k]);
@@ -269,6 +419,15 @@ struct stat_t *parallel_breadth_first_search(struct graph_t *G, struct edgelist_
   free(BFS->pool);
   free(BFS);
 
+#if IO_WORKER_BFS == 1
+  stop_io_workers(io_workers);
+  io_workers = NULL;
+#endif
+#if PREFETCH_NEXT_LEVEL == 1
+  stop_io_workers(prefetch_workers);
+  prefetch_workers = NULL;
+#endif
+
   /* close files */
   close_files(DF_s);
   close_files(DF_e);
@@ -424,10 +583,410 @@ static inline int get_bit_offset(UL_t *bits) {
 }
 
 
+/* ------------------------------------------------------------ *
+ * fetch_exmem_tails
+ *   reads the CSR-index of req_v[] from the start file by coalesced
+ *   requests, and sets ext[] to the first max_len edges of each tail
+ *   (req_end[] is the end of the tail). empty tails are dropped.
+ *   with a layout, the tails are moved to their position in the layout
+ *   file. the hot tails (at least LAYOUT_BLOCK_EDGES edges) precede the
+ *   cold ones in the file, and both are in ID order, so the hot run is
+ *   compacted in place, the cold run is kept in cold[] (3 x nreq) and
+ *   appended to it, which sorts the extents for the coalesced reads.
+ * ------------------------------------------------------------ */
+static I64_t fetch_exmem_tails(const struct file_info_t *fi_start, struct direct_cache_t *C_s, I64_t *buf, I64_t buf_length,
+                               I64_t offset, const I64_t *layout, I64_t *req_v, I64_t *req_skip, I64_t *req_end,
+                               I64_t *cold, struct read_extent_t *ext, I64_t nreq, I64_t max_len) {
+  I64_t r, q, x, c = 0, nc = 0;
+  I64_t *cold_v = &cold[0], *cold_pos = &cold[nreq], *cold_end = &cold[2*nreq];
+  for (x = 0; x < nreq; ++x) {
+    ext[x].pos = req_v[x] - offset;
+    ext[x].len = 2;
+  }
+  for (r = 0; r < nreq; r = q) {
+    q = read_coalesced_extents(fi_start, C_s, buf, buf_length, ext, r, nreq, coalesce_gap);
+    for (x = r; x < q; ++x) {
+      I64_t fs = ext[x].data[0] + req_skip[x];
+      I64_t fe = ext[x].data[1];
+      if (fs < fe) {
+        if (layout) {
+          fe = layout[req_v[x]] + (fe - fs);
+          fs = layout[req_v[x]];
+          if (fe - fs < (I64_t)LAYOUT_BLOCK_EDGES) {
+            cold_v[nc]   = req_v[x];
+            cold_pos[nc] = fs;
+            cold_end[nc] = fe;
+            ++nc;
+            continue;
+          }
+        }
+        req_v[c]   = req_v[x];
+        req_end[c] = fe;
+        ext[c].pos = fs;
+        ext[c].len = MIN(fe - fs, max_len);
+        ++c;
+      }
+    }
+  }
+  for (x = 0; x < nc; ++x, ++c) {
+    req_v[c]   = cold_v[x];
+    req_end[c] = cold_end[x];
+    ext[c].pos = cold_pos[x];
+    ext[c].len = MIN(cold_end[x] - cold_pos[x], max_len);
+  }
+  return c;
+}
+
+
+/* ------------------------------------------------------------ *
+ * exmem batch
+ *   a batch holds up to COALESCE_MAX_REQUESTS external tails and a
+ *   slot of the dump buffer. fetch_exmem_batch reads the CSR-index and
+ *   the first round of coalesced tails (on an I/O worker if
+ *   IO_WORKER_BFS), and scan_exmem_batch_* traverses the tails, reading
+ *   the rest in place.
+ * ------------------------------------------------------------ */
+static void init_exmem_batch(struct exmem_batch_t *B, const struct file_info_t *fi_start,
+                             const struct file_info_t *fi_end, void *buf, I64_t buf_length, I64_t offset) {
+  B->fi_start   = fi_start;
+  B->fi_end     = fi_end;
+  B->buf        = (I64_t *)buf;
+  B->buf_length = buf_length;
+  B->offset     = offset;
+  B->nreq       = 0;
+  B->C_s        = NULL;
+  B->C_e        = NULL;
+#if DIRECT_IO_BFS == 1
+  const size_t cache_e_size = DIRECT_CACHE_SIZE(DUMP_BUF_LENGTH * sizeof(I64_t));
+  init_direct_cache(&B->cache_e, buf, cache_e_size);
+  init_direct_cache(&B->cache_s, (unsigned char *)buf + cache_e_size,
+                    DIRECT_CACHE_SIZE(2 * sizeof(I64_t)));
+  B->C_s = &B->cache_s;
+  B->C_e = &B->cache_e;
+#endif
+}
+
+static void fetch_exmem_batch(struct exmem_batch_t *B) {
+#if PROFILE_IO == 1
+  if (io_stat) __sync_fetch_and_add(&io_stat->needed_bytes, (long)(2 * sizeof(I64_t) * B->nreq));
+#endif
+  B->nreq = fetch_exmem_tails(B->fi_start, B->C_s, B->buf, B->buf_length, B->offset, B->layout,
+                              B->req_v, B->req_skip, B->req_end, B->cold, B->ext, B->nreq, B->max_len);
+  B->nfetched = 0;
+  if (B->nreq > 0) {
+    B->nfetched = read_coalesced_extents(B->fi_end, B->C_e, B->buf, B->buf_length,
+                                         B->ext, 0, B->nreq, coalesce_gap);
+  }
+}
+
+#if IO_WORKER_BFS == 1
+static void fetch_exmem_batch_job(struct io_job_t *job) {
+  fetch_exmem_batch((struct exmem_batch_t *)job);
+}
+
+/* posts B (if not empty) to the I/O workers of the node and returns the
+   next batch of the ring; it is either empty or fetched and to be scanned. */
+static struct exmem_batch_t *post_exmem_batch(struct exmem_batch_t *batch, struct exmem_batch_t *B, int nodeid) {
+  if (B->nreq > 0) {
+    B->job.func = fetch_exmem_batch_job;
+    B->posted = 1;
+    post_io_job(io_workers, nodeid, &B->job);
+  }
+  B = &batch[ (B - batch + 1) % IO_BATCHES_PER_THREAD ];
+  if (B->posted) {
+    wait_io_job(&B->job);
+    B->posted = 0;
+  }
+  return B;
+}
+#endif
+
+static void scan_exmem_batch_topdown(struct bfs_t *BFS, I64_t log_c, struct exmem_batch_t *B, I64_t buf_read_length,
+                                     I64_t *ptop_edges, I64_t *queue_count, I64_t *scanned_edges) {
+  I64_t r, q, x, j;
+  I64_t rm_e, pos_e, read_length_e;
+  const I64_t *edges_e = NULL;
+  I64_t top_edges = 0, count = 0, scanned = 0;
+
+  for (r = 0; r < B->nreq; r = q) {
+    q = (r == 0) ? B->nfetched
+                 : read_coalesced_extents(B->fi_end, B->C_e, B->buf, B->buf_length,
+                                          B->ext, r, B->nreq, coalesce_gap);
+
+    for (x = r; x < q; ++x) {
+      const I64_t vk = B->req_v[x];
+      pos_e = B->ext[x].pos;
+      rm_e = B->req_end[x] - pos_e; // sequential area in file
+      edges_e = B->ext[x].data;
+      scanned += rm_e;
+#if PLACEMENT_PROFILE == 1
+      B->access[vk] += rm_e;
+#endif
+
+      // -- search unvisited vertecies -- //
+      while(rm_e > 0) {
+
+        // -- buffered read for edges (tail exceeds the buffer) -- //
+        if (edges_e) {
+          read_length_e = rm_e;
+        } else {
+          read_length_e = MIN(rm_e, buf_read_length);
+          edges_e = (const I64_t *)read_extent(B->fi_end, B->C_e, B->buf,
+                                               sizeof(I64_t)*pos_e, sizeof(I64_t)*read_length_e);
+        }
+        rm_e  -= read_length_e;
+        pos_e += read_length_e;
+
+        for (j = 0; j < read_length_e; ++j) {
+          const I64_t w = edges_e[j];
+          const int u = (int)( w >> log_c );
+
+          const I64_t target_bit_offset = BFS->bfs_local[ u ].bit_offset;
+          UL_t  *target_visited = &( BFS->bfs_local[ u ].visited[0 - target_bit_offset] );
+
+          if ( ! ISSET_BITMAP(target_visited, w) ) { // w is unvisited
+            if ( ! IS_TEST_AND_SET_BITMAP(target_visited, w) ) { // visit w
+              UL_t *target_neighbors = &( BFS->bfs_local[ u ].neighbors[0 - target_bit_offset] );
+
+              top_edges += 16;
+              const I64_t target_offset = BFS->bfs_local[ u ].offset;
+              I64_t *target_tree = &BFS->bfs_local[ u ].tree[0 - target_offset];
+              target_tree[w] = vk;
+
+              TEST_AND_SET_BITMAP(target_neighbors, w);
+              ++count;
+
+            }
+          }
+        }
+        edges_e = NULL;
+
+      }
+    }
+  }
+  B->nreq = 0;
+
+  *ptop_edges    += top_edges;
+  *queue_count   += count;
+  *scanned_edges += scanned;
+}
+
+static void scan_exmem_batch_bottomup(struct exmem_batch_t *B, I64_t max_read_length,
+                                      const UL_t *frontier, I64_t *tree, UL_t *visited, UL_t *neighbors,
+                                      I64_t *queue_count, I64_t *scanned_edges) {
+  I64_t r, q, x, j;
+  I64_t rm_e, pos_e, read_length_e, next_length_e, cov_e;
+  const I64_t *edges_e = NULL;
+  I64_t count = 0, scanned = 0;
+
+  for (r = 0; r < B->nreq; r = q) {
+    q = (r == 0) ? B->nfetched
+                 : read_coalesced_extents(B->fi_end, B->C_e, B->buf, B->buf_length,
+                                          B->ext, r, B->nreq, coalesce_gap);
+    /* the coalesced read covers the file up to cov_e */
+    for (cov_e = 0, x = r; x < q; ++x) {
+      if (B->ext[x].data) cov_e = MAX(cov_e, B->ext[x].pos + B->ext[x].len);
+    }
+
+    for (x = r; x < q; ++x) {
+      const I64_t wk = B->req_v[x];
+      pos_e = B->ext[x].pos;
+      rm_e = B->req_end[x] - pos_e; // sequential area in file
+      edges_e = B->ext[x].data;
+      read_length_e = B->ext[x].len;
+      next_length_e = read_length_e;
+
+      // -- search fronter -- //
+      while(rm_e > 0) {
+
+        // -- the rest of the tail in the coalesced read, then buffered
+        //    reads growing while the scan misses. a read reuses the
+        //    buffer, so the extents after x are read again. -- //
+        if (!edges_e && B->ext[x].data && pos_e < cov_e) {
+          read_length_e = MIN(rm_e, cov_e - pos_e);
+          edges_e = &B->ext[x].data[pos_e - B->ext[x].pos];
+        } else if (!edges_e) {
+          next_length_e = MIN(2 * next_length_e, max_read_length);
+          read_length_e = MIN(rm_e, next_length_e);
+          edges_e = (const I64_t *)read_extent(B->fi_end, B->C_e, B->buf,
+                                               sizeof(I64_t)*pos_e, sizeof(I64_t)*read_length_e);
+          q = x+1;
+        }
+        rm_e  -= read_length_e;
+        pos_e += read_length_e;
+#if PLACEMENT_PROFILE == 1
+        B->access[wk] += read_length_e;
+#endif
+
+        for (j = 0; j < read_length_e; ++j) {
+          I64_t tail = edges_e[j];
+          ++scanned;
+          if ( ISSET_BITMAP(frontier, tail) ) { // frontier is found
+            tree[wk] = tail;
+            SET_BITMAP(visited, wk);
+            SET_BITMAP(neighbors, wk);
+            ++count;
+            goto next_request_btm; // goto next vertex
+          }
+        }
+        edges_e = NULL;
+      } // end of reading BG from file
+
+next_request_btm: ;
+
+    }
+  }
+  B->nreq = 0;
+
+  *queue_count   += count;
+  *scanned_edges += scanned;
+}
+
+
+#if PREFETCH_NEXT_LEVEL == 1
+/* ------------------------------------------------------------ *
+ * prefetch_exmem_tails
+ *   an I/O-worker job starting read-ahead of the external tails of
+ *   the vertices set in words [ls, le) of bits (the merged frontier
+ *   for top-down), or of the unset ones (the unvisited vertices for
+ *   bottom-up if is_negated), max_len edges of each. it walks the
+ *   whole range in rounds of COALESCE_MAX_REQUESTS, in the order of
+ *   the next scan, and reads the CSR-index into its own buffer, so the
+ *   BFS thread only posts it. visited[] may be set by the scan while
+ *   the job reads it, which at most prefetches a tail not needed.
+ * ------------------------------------------------------------ */
+static void prefetch_exmem_round(struct exmem_batch_t *B) {
+  I64_t x;
+  B->nreq = fetch_exmem_tails(B->fi_start, B->C_s, B->buf, B->buf_length, B->offset, B->layout,
+                              B->req_v, B->req_skip, B->req_end, B->cold, B->ext, B->nreq, B->max_len);
+
+  // -- merge neighboring tails into a read-ahead request -- //
+  for (x = 0; x < B->nreq; ) {
+    const I64_t pos = B->ext[x].pos;
+    I64_t end = pos + B->ext[x].len;
+    for (++x; x < B->nreq && B->ext[x].pos >= end && B->ext[x].pos - end <= coalesce_gap; ++x) {
+      end = B->ext[x].pos + B->ext[x].len;
+    }
+    prefetch_file(B->fi_end, sizeof(I64_t)*(end - pos), sizeof(I64_t)*pos);
+  }
+  B->nreq = 0;
+}
+
+static void prefetch_exmem_tails(struct io_job_t *job) {
+  struct prefetch_job_t *P = (struct prefetch_job_t *)job;
+  struct exmem_batch_t *B = &P->B;
+  I64_t i;
+  B->nreq = 0;
+  for (i = P->ls; i < P->le; ++i) {
+    UL_t word = (P->is_negated) ? ~P->bits[i] : P->bits[i];
+    I64_t k = -1;
+    while (word != 0) {
+      k += get_bit_offset(&word);
+      const I64_t v = BIT_v(i,0) + k;
+      const I64_t dg = P->BG_start[v+1] - P->BG_start[v];
+      if (dg < max_onmem_edges) continue;
+      if (P->sig && !(P->sig[v] & P->blocks)) continue;
+      B->req_v[B->nreq]    = v;
+      B->req_skip[B->nreq] = dg;
+      ++B->nreq;
+    }
+    if ( B->nreq == 0 ) continue;
+    if ( B->nreq + (I64_t)UL_SHIFT <= (I64_t)COALESCE_MAX_REQUESTS && i < P->le-1 ) continue;
+    prefetch_exmem_round(B);
+  }
+}
+#endif
+
+
+#if READ_LENGTH_PROBE == 1
+/* ------------------------------------------------------------ *
+ * probe_read_lengths
+ *   times READ_PROBE_ROUNDS reads of each power-of-two size at
+ *   scattered offsets of an end file (page cache dropped), and sets
+ *   the unset read lengths: the first bottom-up read is the largest
+ *   size costing about the latency of the smallest one, and the reads
+ *   grow up to the size where the device becomes bandwidth-bound
+ *   (doubling the size nearly doubles the time).
+ * ------------------------------------------------------------ */
+static int probe_cmp(const void *a, const void *b) {
+  const double x = *(const double *)a, y = *(const double *)b;
+  return (x > y) - (x < y);
+}
+
+static void probe_read_lengths(const struct file_info_t *fi_end, I64_t *buf, I64_t buf_length) {
+  enum { MAX_PROBES = 32 };
+  double t[MAX_PROBES], round_t[MAX_PROBES][READ_PROBE_ROUNDS];
+  I64_t len[MAX_PROBES];
+  int i, r, np = 0;
+
+  if (fi_end->farmem) return ;  /* zero-copy reads */
+  const I64_t file_edges = (fi_end->cindex) ? fi_end->cindex->num_edges
+                                            : (I64_t)(size_file(fi_end) / sizeof(I64_t));
+  for (I64_t l = READ_LENGTH_MIN; l <= MIN(buf_length, file_edges) && np < MAX_PROBES; l *= 2) {
+    len[np++] = l;
+  }
+  if (np == 0) return ;
+
+  struct direct_cache_t *C = NULL;
+#if DIRECT_IO_BFS == 1
+  struct direct_cache_t cache;
+  init_direct_cache(&cache, buf, DIRECT_CACHE_SIZE(DUMP_BUF_LENGTH * sizeof(I64_t)));
+  C = &cache;
+#endif
+  read_extent(fi_end, C, buf, 0, sizeof(I64_t)*len[0]);  /* warm-up */
+
+  // -- a round reads each size once, so the cache state is alike for all sizes -- //
+  UL_t seed = 0x9e3779b97f4a7c15ULL;
+  for (r = 0; r < READ_PROBE_ROUNDS; ++r) {
+#if DIRECT_IO_BFS == 0
+    drop_pagecache_file_info((struct file_info_t *)fi_end);
+#endif
+    for (i = 0; i < np; ++i) {
+      seed = seed * 6364136223846793005ULL + 1442695040888963407ULL;
+      const I64_t pos = (I64_t)((seed >> 16) % (UL_t)(file_edges - len[i] + 1));
+      if (C) C->valid = 0;
+      const double t1 = get_seconds();
+      read_extent(fi_end, C, buf, sizeof(I64_t)*pos, sizeof(I64_t)*len[i]);
+      round_t[i][r] = get_seconds() - t1;
+    }
+  }
+#if DIRECT_IO_BFS == 0
+  drop_pagecache_file_info((struct file_info_t *)fi_end);
+#endif
+  for (i = 0; i < np; ++i) {
+    qsort(round_t[i], READ_PROBE_ROUNDS, sizeof(double), probe_cmp);
+    t[i] = round_t[i][READ_PROBE_ROUNDS / 2];
+  }
+
+  I64_t bu = len[0], max = len[np-1];
+  for (i = 1; i < np && t[i] <= 1.25 * t[0]; ++i) {
+    bu = len[i];
+  }
+  for (i = 0; i+1 < np; ++i) {
+    if (t[i+1] >= 1.8 * t[i]) {
+      max = len[i];
+      break;
+    }
+  }
+  printf("read probe: %lld edges %.1f us, %lld edges %.1f us (%.1f MB/s)\n",
+         len[0], t[0] * 1e6, len[np-1], t[np-1] * 1e6,
+         sizeof(I64_t) * len[np-1] / MAX(t[np-1], 1e-9) * 1e-6);
+  if (read_length_bu  <= 0) read_length_bu  = bu;
+  if (read_length_max <= 0) read_length_max = MAX(max, bu);
+}
+#endif
+
+
 enum {
   ALGO_TOPDOWN, ALGO_BOTTOMUP,
 };
 
+#if PROFILE_IO == 1
+struct io_level_t {
+  long requests, syscalls, bytes, needed_bytes, io_nsec, blocked_nsec;
+};
+#endif
+
 struct hist_t {
   int algorithm;
   long frontier_nodes;
@@ -444,8 +1003,51 @@ struct hist_t {
   int flag;
   double elapsed_time;
   double merge_time;
+#if PROFILE_IO == 1
+  struct io_level_t io;
+  unsigned long io_size_p50, io_latency_p50, io_latency_p99;
+#endif
 };
 
+#if PROFILE_IO == 1
+static void add_io_level(struct io_level_t *L, const struct io_level_t *S) {
+  __sync_fetch_and_add(&L->requests,     S->requests);
+  __sync_fetch_and_add(&L->syscalls,     S->syscalls);
+  __sync_fetch_and_add(&L->bytes,        S->bytes);
+  __sync_fetch_and_add(&L->needed_bytes, S->needed_bytes);
+  __sync_fetch_and_add(&L->io_nsec,      S->io_nsec);
+  __sync_fetch_and_add(&L->blocked_nsec, S->blocked_nsec);
+}
+
+/* IO_PROFILE file: a line for each level (thread -1) and each thread of the level */
+static void dump_io_profile(const struct hist_t *hist, I64_t hops, const struct io_level_t *thread_io, int num_threads) {
+  static int num_bfs = 0;
+  const char *fname = getenv(ENV_IO_PROFILE);
+  if (!fname) return ;
+  FILE *fp = NULL;
+  assert( fp = fopen(fname, (num_bfs == 0) ? "w" : "a") );
+  if (num_bfs == 0) {
+    fprintf(fp, "# bfs\tlevel\talgorithm\tthread\ttime[s]\trequests\tsyscalls\tbytes\tneeded_bytes"
+                "\tio_time[s]\tblocked_time[s]\tsize_p50[B]\tlatency_p50[ns]\tlatency_p99[ns]\n");
+  }
+  for (I64_t i = 0; i <= hops; ++i) {
+    for (int id = -1; id < num_threads; ++id) {
+      const struct io_level_t *L = (id < 0) ? &hist[i].io : &thread_io[i * num_threads + id];
+      fprintf(fp, "%d\t%lld\t%s\t%d\t%.6f\t%ld\t%ld\t%ld\t%ld\t%.6f\t%.6f",
+              num_bfs, i, !hist[i].algorithm ? "TopDown":"BottomUp", id, hist[i].elapsed_time,
+              L->requests, L->syscalls, L->bytes, L->needed_bytes, L->io_nsec * 1e-9, L->blocked_nsec * 1e-9);
+      if (id < 0) {
+        fprintf(fp, "\t%lu\t%lu\t%lu\n", hist[i].io_size_p50, hist[i].io_latency_p50, hist[i].io_latency_p99);
+      } else {
+        fprintf(fp, "\t-\t-\t-\n");
+      }
+    }
+  }
+  fclose(fp);
+  ++num_bfs;
+}
+#endif
+
 static I64_t make_local_bfs_tree(struct graph_t *G, struct bfs_t *BFS, I64_t s, I64_t *thresholds,
                                  struct dumpfiles_t *DF_BG_s, struct dumpfiles_t *DF_BG_e, struct dump_buffer_t *BF) {
   double elapsed_offset = get_seconds();
@@ -457,6 +1059,14 @@ static I64_t make_local_bfs_tree(struct graph_t *G, struct bfs_t *BFS, I64_t s,
   I64_t total_scanned_edges_onmem;
   I64_t total_scanned_edges_exmem;
 
+ #if PROFILE_IO == 1
+  const int num_threads = get_numa_num_threads();
+  struct io_stat_t *level_io = NULL;      /* histograms of the current level */
+  struct io_level_t *thread_io = NULL;    /* [level][thread] */
+  assert( level_io  = (struct io_stat_t *)calloc(1, sizeof(struct io_stat_t)) );
+  assert( thread_io = (struct io_level_t *)calloc(MAX_HISTS * num_threads, sizeof(struct io_level_t)) );
+ #endif
+
  #if PROFILE_DETAIL == 1
     I64_t total_scanned_vertex_onmem;
     I64_t total_scanned_vertex_exmem;
@@ -466,6 +1076,12 @@ static I64_t make_local_bfs_tree(struct graph_t *G, struct bfs_t *BFS, I64_t s,
   I64_t hops = -1;
   I64_t master_queue_count    = 1; /* for shared queue size */
   I64_t shared_topdown_edges  = 0; /* for parameter estimating */
+#if TAIL_SIGNATURE == 1
+  UL_t frontier_blocks       = TAIL_SIG_BLOCK(s);  /* blocks with frontier vertices  */
+  UL_t unvisited_blocks      = ~0UL;               /* blocks with unvisited vertices */
+  UL_t next_frontier_blocks  = 0;
+  UL_t next_unvisited_blocks = 0;
+#endif
 
   assert( BIT_j(G->n) == 0 );
 
@@ -505,21 +1121,54 @@ static I64_t make_local_bfs_tree(struct graph_t *G, struct bfs_t *BFS, I64_t s,
     I64_t range_ls, range_le, bit_range_ls, bit_range_le, bit_n_ls, bit_n_le;
 
     /* file discripter for graph */
-    int fd_start = DF_BG_s->file_info_list[id].fd;
-    int fd_end   = DF_BG_e->file_info_list[id].fd;
+    const struct file_info_t *fi_start = &DF_BG_s->file_info_list[id];
+    const struct file_info_t *fi_end   = &DF_BG_e->file_info_list[id];
 
     /* for buffered I/O */
-    I64_t rm_e, read_length_e;
-    I64_t *read_buf_e = BF->buffer_list[id].buf; // NUMA optimized buffer
-    const I64_t buf_read_length_TD = MIN((I64_t)BF->buffer_list[id].length, (I64_t)DUMP_BUF_READ_LENGTH_TD);
-    const I64_t buf_read_length_BU = MIN((I64_t)BF->buffer_list[id].length, (I64_t)DUMP_BUF_READ_LENGTH_BU);
-    I64_t start_buf[2];
-
+    unsigned char *read_buf_e = (unsigned char *)BF->buffer_list[id].buf; // NUMA optimized buffer
+    const I64_t buf_length_e = BF->buffer_list[id].length;
+    const I64_t buf_read_length_TD = buf_length_e;  // whole tails
+    const I64_t buf_read_length_BU = MIN(buf_length_e, read_length_bu);
+    const I64_t buf_read_length_max = MIN(buf_length_e, read_length_max);
+
+    /* for coalesced (and asynchronous) I/O : a batch for each buffer slot */
+    struct exmem_batch_t *batch = NULL, *B = NULL;
+    assert( batch = (struct exmem_batch_t *)calloc(DUMP_BUF_SLOTS, sizeof(struct exmem_batch_t)) );
+    for (i = 0; i < (I64_t)DUMP_BUF_SLOTS; ++i) {
+      init_exmem_batch(&batch[i], fi_start, fi_end, read_buf_e + i * DUMP_BUF_SLOT_SIZE, buf_length_e, offset);
+#if PLACEMENT_PROFILE == 1
+      batch[i].access = &exmem_access[nodeid][0 - offset];
+#endif
+#if LAYOUT_GRAPH_TAILS == 1
+      batch[i].layout = &tail_layout[nodeid][0 - offset];
+#endif
+    }
+    B = &batch[0];
+#if TAIL_SIGNATURE == 1
+    const UL_t *sig = &tail_sig[nodeid][0 - offset];
+#endif
+#if PREFETCH_NEXT_LEVEL == 1
+    struct prefetch_job_t *P = NULL;
+    void *prefetch_buf = NULL;
+    assert( P = (struct prefetch_job_t *)calloc(1, sizeof(struct prefetch_job_t)) );
+    assert( prefetch_buf = malloc(DUMP_BUF_SLOT_SIZE) );
+    init_exmem_batch(&P->B, fi_start, fi_end, prefetch_buf, buf_length_e, offset);
+    P->B.layout = batch[0].layout;
+    P->BG_start = BG_start;
+  #if TAIL_SIGNATURE == 1
+    P->sig      = sig;
+  #endif
+#endif
 
     /* for profile */
+    I64_t scanned_edges_exmem = 0;
+#if PROFILE_IO == 1
+    struct io_stat_t *my_io = NULL;
+    assert( my_io = (struct io_stat_t *)calloc(1, sizeof(struct io_stat_t)) );
+    io_stat = my_io;
+#endif
 #if PROFILE == 1
     I64_t scanned_edges_onmem;
-    I64_t scanned_edges_exmem;
   #if PROFILE_DETAIL == 1
     I64_t scanned_vertex_onmem;
     I64_t scanned_vertex_exmem;
@@ -593,7 +1242,7 @@ static I64_t make_local_bfs_tree(struct graph_t *G, struct bfs_t *BFS, I64_t s,
         const double ts = get_seconds();
 
         drop_pagecache_file(DF_BG_s->file_info_list[id].fname);
-        drop_pagecache_file(DF_BG_e->file_info_list[id].fname);
+        drop_pagecache_file_info(&DF_BG_e->file_info_list[id]);
 
         const double droping_time = get_seconds() - ts;
         printf("drop pagecache takes %lf seconds\n", droping_time);
@@ -662,62 +1311,52 @@ static I64_t make_local_bfs_tree(struct graph_t *G, struct bfs_t *BFS, I64_t s,
               }
             }
 
+#if PLACEMENT_PROFILE == 1
+            // -- a tail kept on DRAM (-f) counts as if it were read from external memory -- //
+            if (fe-fs > max_onmem_edges) B->access[v+k] += fe-fs - max_onmem_edges;
+#endif
+
             /* ------------------------------- read from external memory ------------------------------- */
             if (fe-fs < max_onmem_edges) {
               continue ;  // go to next vertex
             }
+#if TAIL_SIGNATURE == 1
+            if ( !(sig[v+k] & unvisited_blocks) ) {
+              continue ;  // no unvisited vertex in the tail
+            }
+#endif
 
-            // -- read csr-index data from file -- //
-            lseek(fd_start, sizeof(I64_t)*(v+k-offset), SEEK_SET);
-            read(fd_start, start_buf, sizeof(I64_t)*2);
-            fs = start_buf[0] + (fe-fs);
-            fe = start_buf[1];
-
-#if PROFILE == 1
-            scanned_edges_exmem += fe - fs;
-          #if PROFILE_DETAIL == 1
+#if PROFILE == 1 && PROFILE_DETAIL == 1
             ++scanned_vertex_exmem;
-          #endif
 #endif
+            // -- defer to coalesced read -- //
+            B->req_v[B->nreq]    = v+k;
+            B->req_skip[B->nreq] = fe-fs;
+            ++B->nreq;
+          }
 
-            lseek(fd_end, sizeof(I64_t)*fs, SEEK_SET);
-            rm_e = fe - fs; // fe - fs is degree of vertex; sequential area in file
-
-            // -- search unvisited vertecies -- //
-            while(rm_e > 0) {
-
-              // -- buffered read for edges -- //
-              read_length_e = MIN(rm_e, buf_read_length_TD);
-              rm_e -= read_length_e;
-              read(fd_end, read_buf_e, sizeof(I64_t)*read_length_e);
-
-
-              for (j = 0; j < read_length_e; ++j) {
-                const I64_t w = read_buf_e[j];
-                const int u = (int)( w >> log_c );
-
-                const I64_t target_bit_offset = BFS->bfs_local[ u ].bit_offset;
-                UL_t  *target_visited = &( BFS->bfs_local[ u ].visited[0 - target_bit_offset] );
-
-                if ( ! ISSET_BITMAP(target_visited, w) ) { // w is unvisited
-                  if ( ! IS_TEST_AND_SET_BITMAP(target_visited, w) ) { // visit w
-                    UL_t *target_neighbors = &( BFS->bfs_local[ u ].neighbors[0 - target_bit_offset] );
-
-                    ptop_edges += 16;
-                    const I64_t target_offset = BFS->bfs_local[ u ].offset;
-                    I64_t *target_tree = &BFS->bfs_local[ u ].tree[0 - target_offset];
-                    target_tree[w] = v+k;
-
-                    TEST_AND_SET_BITMAP(target_neighbors, w);
-                    ++thread_queue_count;
+          if ( B->nreq == 0 ) continue;
+          if ( B->nreq + (I64_t)UL_SHIFT <= (I64_t)COALESCE_MAX_REQUESTS && i < le-1 ) continue;
 
-                  }
-                }
-              }
+          // -- read csr-index data and tails from file -- //
+          B->max_len = INT64_MAX;
+#if IO_WORKER_BFS == 1
+          B = post_exmem_batch(batch, B, nodeid);
+#else
+          fetch_exmem_batch(B);
+#endif
+          scan_exmem_batch_topdown(BFS, log_c, B, buf_read_length_TD,
+                                   &ptop_edges, &thread_queue_count, &scanned_edges_exmem);
+        }
 
-            }
-          }
+#if IO_WORKER_BFS == 1
+        // -- consume the completions of this level -- //
+        for (i = 0; i < (I64_t)IO_BATCHES_PER_THREAD; ++i) {
+          B = post_exmem_batch(batch, B, nodeid);
+          scan_exmem_batch_topdown(BFS, log_c, B, buf_read_length_TD,
+                                   &ptop_edges, &thread_queue_count, &scanned_edges_exmem);
         }
+#endif
 
 
       } else {
@@ -756,9 +1395,16 @@ static I64_t make_local_bfs_tree(struct graph_t *G, struct bfs_t *BFS, I64_t s,
                 tree[w+k] = tail;
                 neighbors_i |= 1ULL << k;
                 ++thread_queue_count;
+#if PLACEMENT_PROFILE == 1
+                if (j-bs >= max_onmem_edges) B->access[w+k] += j-bs - max_onmem_edges + 1;
+#endif
                 goto next_vertex_btm;
               }
             }
+#if PLACEMENT_PROFILE == 1
+            // -- a tail kept on DRAM (-f) counts as if it were read from external memory -- //
+            if (be-bs > max_onmem_edges) B->access[w+k] += be-bs - max_onmem_edges;
+#endif
 
 
 
@@ -766,42 +1412,19 @@ static I64_t make_local_bfs_tree(struct graph_t *G, struct bfs_t *BFS, I64_t s,
              if (be-bs < max_onmem_edges) {
               goto next_vertex_btm;  // go to next vertex
             }
-
-            // -- read csr-index data from file -- //
-            lseek(fd_start, sizeof(I64_t)*(w+k-offset), SEEK_SET);
-            read(fd_start, start_buf, sizeof(I64_t)*2);
-            bs = start_buf[0] + (be-bs);
-            be = start_buf[1];
-
-#if PROFILE_DETAIL == 1 && PROFILE_DETAIL == 1
-            ++scanned_vertex_exmem;
+#if TAIL_SIGNATURE == 1
+            if ( !(sig[w+k] & frontier_blocks) ) {
+              goto next_vertex_btm;  // no frontier vertex in the tail
+            }
 #endif
 
-            lseek(fd_end, sizeof(I64_t)*bs, SEEK_SET);
-            rm_e = be - bs; // be - bs is degree of vertex; sequential area in file
-
-            // -- search fronter -- //
-            while(rm_e > 0) {
-
-              // -- buffered read edges -- //
-              read_length_e = MIN(rm_e, buf_read_length_BU);
-              rm_e -= read_length_e;
-              read(fd_end, read_buf_e, sizeof(I64_t)*read_length_e);
-
-
-              for (j = 0; j < read_length_e; ++j) {
-                I64_t tail = read_buf_e[j];
-#if PROFILE == 1
-                ++scanned_edges_exmem;
+#if PROFILE == 1 && PROFILE_DETAIL == 1
+            ++scanned_vertex_exmem;
 #endif
-                if ( ISSET_BITMAP(frontier, tail) ) { // frontier is found
-                  tree[w+k] = tail;
-                  neighbors_i |= 1ULL << k;
-                  ++thread_queue_count;
-                  goto next_vertex_btm; // goto next vertex
-                }
-              }
-            } // end of reading BG from file
+            // -- defer to coalesced read -- //
+            B->req_v[B->nreq]    = w+k;
+            B->req_skip[B->nreq] = be-bs;
+            ++B->nreq;
 
 next_vertex_btm: ;
 
@@ -810,16 +1433,57 @@ next_vertex_btm: ;
           visited[i] |= neighbors_i;
           neighbors[i] = neighbors_i;
 
-        } // end of bottom-up approarch
+          if ( B->nreq == 0 ) continue;
+          if ( B->nreq + (I64_t)UL_SHIFT <= (I64_t)COALESCE_MAX_REQUESTS && i < le-1 ) continue;
 
-      }
+          // -- read csr-index data and the first chunk of tails from file -- //
+          B->max_len = buf_read_length_BU;
+#if IO_WORKER_BFS == 1
+          B = post_exmem_batch(batch, B, nodeid);
+#else
+          fetch_exmem_batch(B);
+#endif
+          scan_exmem_batch_bottomup(B, buf_read_length_max, frontier, tree, visited, neighbors,
+                                    &thread_queue_count, &scanned_edges_exmem);
 
+        } // end of bottom-up approarch
 
+#if IO_WORKER_BFS == 1
+        // -- consume the completions of this level -- //
+        for (i = 0; i < (I64_t)IO_BATCHES_PER_THREAD; ++i) {
+          B = post_exmem_batch(batch, B, nodeid);
+          scan_exmem_batch_bottomup(B, buf_read_length_max, frontier, tree, visited, neighbors,
+                                    &thread_queue_count, &scanned_edges_exmem);
+        }
+#endif
+
+      }
+#if PREFETCH_NEXT_LEVEL == 1
+      /* the read-ahead walks frontier[], which the swap clears */
+      if (P->posted) {
+        wait_io_job(&P->job);
+        P->posted = 0;
+      }
+#endif
       /* merge queue */
       __sync_fetch_and_add(&shared_topdown_edges, ptop_edges);
 #if PROFILE == 1
       __sync_fetch_and_add(&total_scanned_edges_onmem, scanned_edges_onmem);
       __sync_fetch_and_add(&total_scanned_edges_exmem, scanned_edges_exmem);
+  #if PROFILE_IO == 1
+      /* all batches of the level are drained here */
+      const struct io_level_t my_level = {
+        my_io->requests, my_io->syscalls, my_io->bytes,
+        my_io->needed_bytes + (long)sizeof(I64_t) * scanned_edges_exmem, my_io->io_nsec, my_io->blocked_nsec
+      };
+      thread_io[level * num_threads + id] = my_level;
+      add_io_level(&hist[level].io, &my_level);
+      for (i = 0; i < IO_HIST_BUCKETS; ++i) {
+        if (my_io->size_hist[i])    __sync_fetch_and_add(&level_io->size_hist[i],    my_io->size_hist[i]);
+        if (my_io->latency_hist[i]) __sync_fetch_and_add(&level_io->latency_hist[i], my_io->latency_hist[i]);
+      }
+      memset(my_io, 0x00, sizeof(struct io_stat_t));
+  #endif
     #if PROFILE_DETAIL == 1
       __sync_fetch_and_add(&total_scanned_vertex_onmem, scanned_vertex_onmem);
       __sync_fetch_and_add(&total_scanned_vertex_exmem, scanned_vertex_exmem);
@@ -865,6 +1529,12 @@ next_vertex_btm: ;
         hist[level].scanned_edges_onmem = total_scanned_edges_onmem;
         hist[level].scanned_edges_exmem = total_scanned_edges_exmem;
         hist[level].scanned_edges = total_scanned_edges_onmem + total_scanned_edges_exmem;
+        #if PROFILE_IO == 1
+          hist[level].io_size_p50    = io_hist_percentile(level_io->size_hist,    0.50);
+          hist[level].io_latency_p50 = io_hist_percentile(level_io->latency_hist, 0.50);
+          hist[level].io_latency_p99 = io_hist_percentile(level_io->latency_hist, 0.99);
+          memset(level_io, 0x00, sizeof(struct io_stat_t));
+        #endif
         #if PROFILE_DETAIL == 1
           hist[level].scanned_vertex_onmem = total_scanned_vertex_onmem;
           hist[level].scanned_vertex_exmem = total_scanned_vertex_exmem;
@@ -885,6 +1555,16 @@ next_vertex_btm: ;
         }
         OMP("omp barrier");
       }
+#if TAIL_SIGNATURE == 1
+      /* block masks of the next level */
+      UL_t fblk = 0, ublk = 0;
+      for (i = bit_range_ls; i < bit_range_le; ++i) {
+        if (  neighbors[i] ) fblk |= TAIL_SIG_BLOCK( BIT_v(i,0) );
+        if ( ~visited[i]   ) ublk |= TAIL_SIG_BLOCK( BIT_v(i,0) );
+      }
+      __sync_fetch_and_or(&next_frontier_blocks,  fblk);
+      __sync_fetch_and_or(&next_unvisited_blocks, ublk);
+#endif
       /* ------------------------------ swap(CQ,NQ) ------------------------------ */
 
 #if PROFILE == 1
@@ -901,18 +1581,60 @@ next_vertex_btm: ;
 #endif
       OMP("omp barrier");
 
+#if TAIL_SIGNATURE == 1
+      if (id == 0) {
+        frontier_blocks       = next_frontier_blocks;
+        unvisited_blocks      = next_unvisited_blocks;
+        next_frontier_blocks  = 0;
+        next_unvisited_blocks = 0;
+      }
+#endif
       start = end;
       end = master_queue_count;
       thread_queue_count = 0;
       frontier_size = end - start;
 
       OMP("omp barrier");
+
+#if PREFETCH_NEXT_LEVEL == 1
+      /* ------------------------------ next-level read-ahead ------------------------------ */
+      if ( end != start ) {
+        if ( algo == ALGO_TOPDOWN ) {
+          P->bits       = frontier;
+          P->is_negated = 0;
+          P->B.max_len  = INT64_MAX;
+  #if TAIL_SIGNATURE == 1
+          P->blocks     = unvisited_blocks;
+  #endif
+        } else {
+          P->bits       = visited;
+          P->is_negated = 1;
+          P->B.max_len  = buf_read_length_BU;
+  #if TAIL_SIGNATURE == 1
+          P->blocks     = frontier_blocks;
+  #endif
+        }
+        P->job.func = prefetch_exmem_tails;
+        P->posted = 1;
+        post_io_job(prefetch_workers, nodeid, &P->job);
+      }
+#endif
     } /* bfs loop */
 
     if (id == 0) {
       hops = level-1;
     }
 
+    free(batch);
+#if PREFETCH_NEXT_LEVEL == 1
+    if (P->posted) wait_io_job(&P->job);
+    free(prefetch_buf);
+    free(P);
+#endif
+#if PROFILE_IO == 1
+    io_stat = NULL;
+    free(my_io);
+#endif
     clear_affinity();
   }
 
@@ -925,6 +1647,10 @@ next_vertex_btm: ;
     long scanned_vertex_onmem = 0, scanned_vertex_exmem = 0;
   #endif
   double merge_time = 0.0;
+  #if PROFILE_IO == 1
+    struct io_level_t io_total;
+    memset(&io_total, 0x00, sizeof(struct io_level_t));
+  #endif
   for (i = 0; i <= hops; ++i) {
     frontier_nodes        += hist[i].frontier_nodes;
     scanned_edges         += hist[i].scanned_edges;
@@ -935,6 +1661,9 @@ next_vertex_btm: ;
     scanned_vertex_exmem  += hist[i].scanned_vertex_exmem;
 #endif
     merge_time            += hist[i].merge_time;
+#if PROFILE_IO == 1
+    add_io_level(&io_total, &hist[i].io);
+#endif
   }
   if ( verbose ) {
     int j;
@@ -944,6 +1673,10 @@ next_vertex_btm: ;
            "TE", "%", "TE/|CQ|", "next-TD[E]", "next-BU[E]", "TEPS", "OnMem-TE", "ExMem-TE");
   #if PROFILE_DETAIL == 1
     printf("  %14s  %14s", "OnMem-SCND-VX", "ExMem-SCND-VX");
+  #endif
+  #if PROFILE_IO == 1
+    printf("  %10s  %10s  %9s  %6s  %8s  %8s  %8s  %6s",
+           "IO-req", "syscall", "IO-MB", "amp", "size50", "lat50us", "lat99us", "blk%");
   #endif
     printf("\n");
 
@@ -975,6 +1708,13 @@ next_vertex_btm: ;
 
       #if PROFILE_DETAIL == 1
         printf("  %14ld  %14ld", hist[i].scanned_vertex_onmem, hist[i].scanned_vertex_exmem);
+      #endif
+      #if PROFILE_IO == 1
+        printf("  %10ld  %10ld  %9.2f  %6.2f  %8lu  %8.1f  %8.1f  %6.1f",
+               hist[i].io.requests, hist[i].io.syscalls, hist[i].io.bytes / 1e6,
+               (double)hist[i].io.bytes / MAX(hist[i].io.needed_bytes, 1),
+               hist[i].io_size_p50, hist[i].io_latency_p50 * 1e-3, hist[i].io_latency_p99 * 1e-3,
+               100.0 * hist[i].io.blocked_nsec * 1e-9 / (hist[i].elapsed_time * num_threads));
       #endif
         printf("\n");
 
@@ -994,9 +1734,20 @@ next_vertex_btm: ;
            scanned_edges_exmem);
   #if PROFILE_DETAIL == 1
     printf("  %14ld  %14ld", scanned_vertex_onmem, scanned_vertex_exmem);
+  #endif
+  #if PROFILE_IO == 1
+    printf("  %10ld  %10ld  %9.2f  %6.2f  %8s  %8s  %8s  %6.1f",
+           io_total.requests, io_total.syscalls, io_total.bytes / 1e6,
+           (double)io_total.bytes / MAX(io_total.needed_bytes, 1), "", "", "",
+           100.0 * io_total.blocked_nsec * 1e-9 / (elapsed_offset * num_threads));
   #endif
     printf("\n");
   }
+  #if PROFILE_IO == 1
+  dump_io_profile(hist, hops, thread_io, num_threads);
+  free(level_io);
+  free(thread_io);
+  #endif
 #endif
   if ( verbose ) {
     printf("TEPS ratio: %e E/s\n", G->m/2.0/elapsed_offset);
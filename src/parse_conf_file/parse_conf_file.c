@@ -54,7 +54,7 @@ struct config_list_t make_configlist_from_conffile(const char *fname, const char
 
 	config_list.list_lenght = num_keys;
 
-	char **value_list  = (char **)malloc(sizeof(char *) * num_keys);
+	char **value_list  = (char **)calloc(num_keys, sizeof(char *)); /* NULL if the key is missing */
 	config_list.value_list  = value_list;
 
 
@@ -0,0 +1,144 @@
+#!/bin/sh
+
+ # ----------------------------------------------------------------------
+ #
+ # This is part of NETAL.
+ #
+ # Copyright (C) 2011-2015 Yuichiro Yasui
+ #
+ # NETAL is free software; you can redistribute it and/or
+ # modify it under the terms of the GNU General Public License
+ # as published by the Free Software Foundation; either version 2
+ # of the License, or (at your option) any later version.
+ #
+ # NETAL is distributed in the hope that it will be useful,
+ # but WITHOUT ANY WARRANTY; without even the implied warranty of
+ # MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ # GNU General Public License for more details.
+ #
+ # You should have received a copy of the GNU General Public License
+ # along with NETAL; if not, write to the Free Software
+ # Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ #
+ #  ----------------------------------------------------------------------
+
+
+### ------------------------------------------------------------
+### before/after comparison of two revisions
+###
+###   usage: scripts/compare_graphs.sh BASE [HEAD [SCALE ...]]
+###     BASE, HEAD : git revisions ('.' is the working tree, default HEAD)
+###     SCALE      : default 14 15
+###
+### builds both trees in a scratch directory (WORKDIR, default mktemp)
+### and, for each SCALE, compares
+###   - the files written by graph500_exm (EDGELIST, GRAPH, SRCS)
+###   - the graph dumped by graph500 (DUMPGRAPH)
+###   - #hops and #edges of every BFS of graph500_restore
+### the runs use -m ONMEDGES (default 4) and OMP_NUM_THREADS as set.
+### prints one line per item and exits with 1 if anything differs.
+### ------------------------------------------------------------
+
+if [ $# -lt 1 ]; then
+    echo "usage: $0 BASE [HEAD [SCALE ...]]"
+    exit 2
+fi
+BASE=$1
+HEAD=${2:-HEAD}
+[ $# -ge 2 ] && shift 2 || shift 1
+SCALES=${*:-"14 15"}
+ONMEDGES=${ONMEDGES:-4}
+
+TOP=$(git rev-parse --show-toplevel) || exit 2
+WORKDIR=${WORKDIR:-$(mktemp -d /tmp/compare_graphs.XXXXXX)}
+echo "work directory: $WORKDIR"
+
+
+### ------------------------------------------------------------
+### build
+### ------------------------------------------------------------
+build_tree() {
+    DIR=$WORKDIR/$1
+    rm -rf $DIR && mkdir -p $DIR
+    if [ "$2" = "." ]; then
+	cp -r $TOP/src $DIR/
+    else
+	git -C $TOP archive $2 src | tar -x -C $DIR || return 1
+    fi
+    # ulibc's fsqrt clashes with fsqrt of newer glibc (C23)
+    sed -i 's/\bfsqrt\b/ulibc_fsqrt/' $DIR/src/ulibc-v1.31/ulibc.h $DIR/src/ulibc-v1.31/stdlib.c
+    ( cd $DIR/src && make > $DIR/make.log 2>&1 )
+    for BIN in graph500 graph500_exmem graph500_restore; do
+	if [ ! -x $DIR/src/$BIN ]; then
+	    echo "$2: building $BIN failed (see $DIR/make.log)"
+	    return 1
+	fi
+    done
+    echo "$2: built in $DIR/src"
+}
+
+
+### ------------------------------------------------------------
+### run : writes "item md5" lines to $DIR/SCALE<s>.sum
+### ------------------------------------------------------------
+run_tree() {
+    DIR=$WORKDIR/$1
+    S=$2
+    SUM=$DIR/SCALE$S.sum
+    : > $SUM
+    rm -rf $DIR/nvm0 $DIR/nvm1 && mkdir -p $DIR/nvm0 $DIR/nvm1
+    cat > $DIR/exmem.conf <<EOF
+EDGELIST $DIR/nvm0/edges:$DIR/nvm1/edges
+GRAPH	 $DIR/nvm0/graph:$DIR/nvm1/graph
+SRCS	 $DIR/nvm0/srcs
+EDGEBCKT $DIR/nvm0/bucket:$DIR/nvm1/bucket
+EOF
+    cd $DIR/src
+
+    EXMEM_CONF_FILE=$DIR/exmem.conf ./graph500_exmem -s $S -m $ONMEDGES > $DIR/exmem_SCALE$S.log 2>&1
+    echo "exmem.status $? $(grep -c '\[error\]' $DIR/exmem_SCALE$S.log)" >> $SUM
+    for F in $(cd $DIR && find nvm0 nvm1 -type f | sort); do
+	echo "$F $(md5sum < $DIR/$F | cut -d' ' -f1)" >> $SUM
+    done
+
+    EXMEM_CONF_FILE=$DIR/exmem.conf ./graph500_restore -s $S -m $ONMEDGES > $DIR/restore_SCALE$S.log 2>&1
+    echo "restore.status $? $(grep -c '\[error\]' $DIR/restore_SCALE$S.log)" >> $SUM
+    echo "restore.bfs $(grep 'bfs(s' $DIR/restore_SCALE$S.log \
+	| sed -E 's/.*bfs\(s= *([0-9]+)\), ([0-9]+) hops, .*, ([0-9]+) edges.*/\1 \2 \3/' \
+	| md5sum | cut -d' ' -f1)" >> $SUM
+
+    # graph500 exits after dumping the graph
+    DUMPGRAPH=$DIR/dumpgraph ./graph500 -s $S > $DIR/dumpgraph_SCALE$S.log 2>&1
+    echo "dumpgraph $(md5sum < $DIR/dumpgraph | cut -d' ' -f1)" >> $SUM
+    rm -f $DIR/dumpgraph
+
+    cd - > /dev/null
+}
+
+
+### ------------------------------------------------------------
+### compare
+### ------------------------------------------------------------
+build_tree base $BASE || exit 1
+build_tree head $HEAD || exit 1
+
+STATUS=0
+for S in $SCALES; do
+    run_tree base $S
+    run_tree head $S
+    echo "SCALE $S"
+    for ITEM in $(cat $WORKDIR/base/SCALE$S.sum $WORKDIR/head/SCALE$S.sum | cut -d' ' -f1 | sort -u); do
+	B=$(grep "^$ITEM " $WORKDIR/base/SCALE$S.sum | cut -d' ' -f2-)
+	H=$(grep "^$ITEM " $WORKDIR/head/SCALE$S.sum | cut -d' ' -f2-)
+	if [ "${ITEM%.status}" != "$ITEM" ] && [ "$B $H" != "0 0 0 0" ]; then
+	    printf "  %-40s FAIL  rc,#errors %s / %s\n" $ITEM "${B:--}" "${H:--}"
+	    STATUS=1
+	elif [ "$B" = "$H" ]; then
+	    printf "  %-40s same  %s\n" $ITEM "$B"
+	else
+	    printf "  %-40s DIFF  %s / %s\n" $ITEM "${B:--}" "${H:--}"
+	    STATUS=1
+	fi
+    done
+done
+exit $STATUS
@@ -0,0 +1,558 @@
+/* ------------------------------------------------------------------------ *
+ * This is part of NETALX.
+ *
+ * Copyright (C) 2013-2015 The GraphCREST Project, Tokyo Institute of Technology
+ *
+ * NETALX is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ * ------------------------------------------------------------------------ */
+
+
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+#include <assert.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+#include <sys/vfs.h>
+#include <linux/magic.h>
+
+#include "snapshot.h"
+#include "atomic.h"
+#include "prng.h"
+
+/* a section is an array stored at pos (SNAPSHOT_ALIGN aligned) */
+struct snapshot_section_t {
+  U64_t pos;
+  U64_t size;       /* bytes */
+  U64_t checksum;
+};
+
+struct snapshot_header_t {
+  char magic[8];
+  I64_t version;
+  I64_t scale;
+  I64_t edgefactor;
+  I64_t generator;    /* 0: Kronecker, 1: R-MAT */
+  I64_t seed;
+  I64_t edge_size;    /* sizeof(struct packed_edge) */
+  I64_t num_nodes;
+  I64_t num_edges;    /* #generated edges */
+  I64_t m;            /* #edges of the graph */
+  I64_t chunk;
+  I64_t num_graphs;
+  I64_t numsrcs;
+  I64_t has_edgelist;
+  struct {
+    I64_t n, m, offset;
+    I64_t edges_offset, edges_length;
+    struct snapshot_section_t start, end, edges;
+  } graph[MAX_NODES];
+  struct snapshot_section_t srcs;
+  U64_t checksum;     /* of the above */
+};
+
+/* a section and its buffer, transferred by the threads of nodeid */
+struct snapshot_io_t {
+  int nodeid;
+  unsigned char *buf;
+  struct snapshot_section_t *S;
+};
+
+
+/* ------------------------------------------------------------
+ * checksum
+ *   sum of mixed (word + index) over the 64-bit words of a section;
+ *   the tail word is zero padded. any part can be summed separately.
+ * ------------------------------------------------------------ */
+static inline U64_t mix64(U64_t x) {
+  x ^= x >> 30; x *= 0xbf58476d1ce4e5b9ULL;
+  x ^= x >> 27; x *= 0x94d049bb133111ebULL;
+  x ^= x >> 31;
+  return x;
+}
+
+static U64_t checksum_bytes(const unsigned char *buf, U64_t pos, U64_t len) {
+  U64_t sum = 0, i;
+  assert( pos % sizeof(U64_t) == 0 );
+  for (i = 0; i + sizeof(U64_t) <= len; i += sizeof(U64_t)) {
+    U64_t w;
+    memcpy(&w, &buf[i], sizeof(U64_t));
+    sum += mix64(w + (pos+i) / sizeof(U64_t) * 0x9e3779b97f4a7c15ULL);
+  }
+  if (i < len) {
+    U64_t w = 0;
+    memcpy(&w, &buf[i], len-i);
+    sum += mix64(w + (pos+i) / sizeof(U64_t) * 0x9e3779b97f4a7c15ULL);
+  }
+  return sum;
+}
+
+static U64_t checksum_header(const struct snapshot_header_t *H) {
+  return checksum_bytes((const unsigned char *)H, 0, offsetof(struct snapshot_header_t, checksum));
+}
+
+
+
+
+/* ------------------------------------------------------------
+ * parallel section I/O
+ * ------------------------------------------------------------ */
+static int io_bytes(int fd, int is_write, unsigned char *buf, U64_t len, U64_t pos) {
+  while (len > 0) {
+    const ssize_t sz = is_write ? pwrite(fd, buf, len, pos) : pread(fd, buf, len, pos);
+    if (sz <= 0) return 1;
+    buf += sz, len -= sz, pos += sz;
+  }
+  return 0;
+}
+
+// copies through the shared mapping map of the file if any, otherwise by
+// pread/pwrite (hugetlbfs supports no write()).
+static int copy_bytes(int fd, unsigned char *map, int is_write, unsigned char *buf, U64_t len, U64_t pos) {
+  if (map) {
+    if (is_write) memcpy(&map[pos], buf, len);
+    else          memcpy(buf, &map[pos], len);
+    return 0;
+  }
+  return io_bytes(fd, is_write, buf, len, pos);
+}
+
+// each section is split by words among the threads of its node, which
+// read/write it in SNAPSHOT_IO_LENGTH pieces and sum the checksum of each
+// piece while it is in the cache. a section with a NULL buf is only summed
+// in map (SNAPSHOT_VERIFY of an attached snapshot). returns #failed I/Os.
+static I64_t transfer_sections(int fd, unsigned char *map, int is_write,
+                               int num_io, struct snapshot_io_t *IO, U64_t *sums) {
+  I64_t failed = 0;
+  memset(sums, 0x00, num_io * sizeof(U64_t));
+
+  OMP("omp parallel num_threads(get_numa_num_threads()) reduction(+:failed)") {
+    int id = omp_get_thread_num();
+    int nodeid = get_numa_nodeid(id);
+    int coreid = get_numa_vircoreid(id);
+    int lcores = get_numa_online_cores(nodeid);
+    pinned(USE_HYBRID_AFFINITY, id);
+    OMP("omp barrier");
+
+    for (int i = 0; i < num_io; ++i) {
+      if (IO[i].nodeid != nodeid) continue;
+      const struct snapshot_section_t *S = IO[i].S;
+      I64_t ws, we;
+      partial_range((S->size + sizeof(U64_t)-1) / sizeof(U64_t), 0, lcores, coreid, &ws, &we);
+      U64_t bs = ws * sizeof(U64_t), be = we * sizeof(U64_t), sum = 0;
+      if (be > S->size) be = S->size;
+      for (U64_t off = bs; off < be; off += SNAPSHOT_IO_LENGTH) {
+        const U64_t len = (be - off < SNAPSHOT_IO_LENGTH) ? be - off : SNAPSHOT_IO_LENGTH;
+        if (!IO[i].buf) {
+          sum += checksum_bytes(&map[S->pos + off], off, len);
+          continue;
+        }
+        if ( copy_bytes(fd, map, is_write, &IO[i].buf[off], len, S->pos + off) ) {
+          ++failed;
+          break;
+        }
+        sum += checksum_bytes(&IO[i].buf[off], off, len);
+      }
+      SYNC_FETCH_AND_ADD((I64_t *)&sums[i], (I64_t)sum);
+    }
+    OMP("omp barrier");
+    clear_affinity();
+  }
+  return failed;
+}
+
+static U64_t place_section(struct snapshot_section_t *S, U64_t pos, U64_t size, U64_t align) {
+  S->pos  = pos;
+  S->size = size;
+  S->checksum = 0;
+  return ROUNDUP(pos + size, align);
+}
+
+static int is_shared_memory_file(int fd) {
+  struct statfs sfs;
+  if (fstatfs(fd, &sfs) != 0) return 0;
+  return sfs.f_type == TMPFS_MAGIC || sfs.f_type == HUGETLBFS_MAGIC;
+}
+
+static I64_t generator_seed(void) {
+  init_random();
+  return (I64_t)userseed;
+}
+
+
+
+
+/* ------------------------------------------------------------
+ * save_snapshot
+ *   written to FILE.tmp and renamed, so that a partially written
+ *   snapshot is never restored. on tmpfs or hugetlbfs, sections are
+ *   hugepage aligned and copied through a shared mapping bound to
+ *   the node of each sub-graph, and the file is attached later.
+ * ------------------------------------------------------------ */
+int save_snapshot(const char *filename, struct graph_t *G, struct edgelist_t *list) {
+  const double t1 = get_seconds();
+  const int with_edgelist = !list->regenerate && getenvi((char *)ENV_SNAPSHOT_EDGELIST, 1) != 0;
+  struct snapshot_header_t *H = NULL;
+  assert( sizeof(struct snapshot_header_t) <= SNAPSHOT_ALIGN );
+  assert( G->num_graphs <= MAX_NODES && G->num_graphs == list->num_lists );
+  assert( H = (struct snapshot_header_t *)calloc(1, SNAPSHOT_ALIGN) );
+
+  memcpy(H->magic, SNAPSHOT_MAGIC, sizeof(H->magic));
+  H->version      = SNAPSHOT_VERSION;
+  H->scale        = SCALE;
+  H->edgefactor   = edgefactor;
+  H->generator    = use_RMAT_generator;
+  H->seed         = generator_seed();
+  H->edge_size    = sizeof(struct packed_edge);
+  H->num_nodes    = G->n;
+  H->num_edges    = list->num_edges;
+  H->m            = G->m;
+  H->chunk        = G->chunk;
+  H->num_graphs   = G->num_graphs;
+  H->numsrcs      = list->numsrcs;
+  H->has_edgelist = with_edgelist;
+
+  char *tmpname = (char *)CALLOCA(strlen(filename) + 8);
+  sprintf(tmpname, "%s.tmp", filename);
+  int fd = open(tmpname, O_RDWR | O_CREAT | O_TRUNC, 0644);
+  if (fd < 0) {
+    printf("[snapshot] cannot create '%s'\n", tmpname);
+    free(H);
+    return 1;
+  }
+  const int is_shared = is_shared_memory_file(fd);
+  const U64_t align = is_shared ? hugepage_size() : SNAPSHOT_ALIGN;
+
+  int num_io = 0;
+  struct snapshot_io_t *IO = (struct snapshot_io_t *)CALLOCA(3 * G->num_graphs * sizeof(struct snapshot_io_t));
+  U64_t *sums = (U64_t *)CALLOCA(3 * G->num_graphs * sizeof(U64_t));
+
+  U64_t pos = place_section(&H->srcs, align, list->numsrcs * sizeof(I64_t), align);
+  for (int k = 0; k < G->num_graphs; ++k) {
+    struct subgraph_t *BG = &G->BG_list[k];
+    H->graph[k].n      = BG->n;
+    H->graph[k].m      = BG->m;
+    H->graph[k].offset = BG->offset;
+    pos = place_section(&H->graph[k].start, pos, (BG->n+1) * sizeof(I64_t), align);
+    pos = place_section(&H->graph[k].end,   pos, BG->m * sizeof(I64_t), align);
+    IO[num_io++] = (struct snapshot_io_t){ k, (unsigned char *)BG->start, &H->graph[k].start };
+    IO[num_io++] = (struct snapshot_io_t){ k, (unsigned char *)BG->end,   &H->graph[k].end   };
+    if (with_edgelist) {
+      struct IJ_list_t *IJ_list = &list->IJ_list[k];
+      H->graph[k].edges_offset = IJ_list->offset;
+      H->graph[k].edges_length = IJ_list->length;
+      pos = place_section(&H->graph[k].edges, pos, IJ_list->length * sizeof(struct packed_edge), align);
+      IO[num_io++] = (struct snapshot_io_t){ k, (unsigned char *)IJ_list->edges, &H->graph[k].edges };
+    }
+  }
+
+  I64_t failed = ftruncate(fd, pos) != 0;
+  unsigned char *map = NULL;
+  if (!failed && is_shared) {
+    map = (unsigned char *)mmap(NULL, pos, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (map == MAP_FAILED) {
+      map = NULL;
+      ++failed;
+    } else if ( enable_affinity() ) {
+      for (int i = 0; i < num_io; ++i) {
+        unsigned long mask = (1ULL << IO[i].nodeid);
+        mbind(&map[IO[i].S->pos], ROUNDUP(IO[i].S->size, align), MPOL_PREFERRED,
+              &mask, sizeof(unsigned long)*8, 0);
+      }
+    }
+  }
+  if (!failed) failed += transfer_sections(fd, map, 1, num_io, IO, sums);
+  for (int i = 0; i < num_io; ++i) {
+    IO[i].S->checksum = sums[i];
+  }
+  H->srcs.checksum = checksum_bytes((unsigned char *)list->srcs, 0, H->srcs.size);
+  if (!failed) failed += copy_bytes(fd, map, 1, (unsigned char *)list->srcs, H->srcs.size, H->srcs.pos);
+  H->checksum = checksum_header(H);
+  if (!failed) failed += copy_bytes(fd, map, 1, (unsigned char *)H, SNAPSHOT_ALIGN, 0);
+  if (map) munmap(map, pos);
+  else if (!failed) failed += fsync(fd) != 0;
+  close(fd);
+
+  if (failed || rename(tmpname, filename) != 0) {
+    printf("[snapshot] failed to write '%s'\n", filename);
+    unlink(tmpname);
+    free(H);
+    return 1;
+  }
+  const double t2 = get_seconds();
+  printf("[snapshot] saved '%s' (%.2f GB%s%s, %.3f seconds)\n", filename,
+         (double)pos / (1ULL<<30), with_edgelist ? ", with edgelist" : "",
+         is_shared ? ", shared memory" : "", t2-t1);
+  free(H);
+  return 0;
+}
+
+
+
+
+/* ------------------------------------------------------------
+ * restore
+ * ------------------------------------------------------------ */
+static const char *check_snapshot_header(const struct snapshot_header_t *H, U64_t file_size,
+                                         int num_lists, I64_t nbfs) {
+  if ( memcmp(H->magic, SNAPSHOT_MAGIC, sizeof(H->magic)) ) return "not a snapshot";
+  if ( H->version != SNAPSHOT_VERSION )         return "version";
+  if ( H->checksum != checksum_header(H) )      return "header checksum";
+  if ( H->scale != SCALE )                      return "SCALE";
+  if ( H->edgefactor != edgefactor )            return "edgefactor";
+  if ( H->generator != use_RMAT_generator )     return "generator";
+  if ( H->seed != generator_seed() )            return "seed";
+  if ( H->edge_size != sizeof(struct packed_edge) ) return "edge size";
+  if ( H->num_graphs != num_lists )             return "#NUMA nodes";
+  if ( H->numsrcs != nbfs )                     return "#BFS roots";
+  I64_t m = 0;
+  for (int k = 0; k < H->num_graphs; ++k) {
+    m += H->graph[k].m;
+    if ( H->graph[k].end.pos + H->graph[k].end.size > file_size ||
+         H->graph[k].edges.pos + H->graph[k].edges.size > file_size ) return "truncated";
+  }
+  if ( m != H->m ) return "#edges";
+  return NULL;
+}
+
+// returns the header of a snapshot that matches this run, with *fd open.
+static struct snapshot_header_t *open_snapshot(const char *filename, int num_lists, I64_t nbfs,
+                                               int *fd, U64_t *file_size) {
+  struct snapshot_header_t *H = NULL;
+  struct stat st;
+
+  *fd = open(filename, O_RDONLY);
+  if (*fd < 0 || fstat(*fd, &st) != 0) {
+    printf("[snapshot] cannot open '%s'\n", filename);
+    if (*fd >= 0) close(*fd);
+    return NULL;
+  }
+  assert( H = (struct snapshot_header_t *)calloc(1, SNAPSHOT_ALIGN) );
+  const char *mismatch = "truncated";
+  if ( (U64_t)st.st_size >= SNAPSHOT_ALIGN && !io_bytes(*fd, 0, (unsigned char *)H, SNAPSHOT_ALIGN, 0) ) {
+    mismatch = check_snapshot_header(H, st.st_size, num_lists, nbfs);
+  }
+  if (mismatch) {
+    printf("[snapshot] '%s' does not match this run (%s)\n", filename, mismatch);
+    close(*fd);
+    free(H);
+    return NULL;
+  }
+  posix_fadvise(*fd, 0, st.st_size, POSIX_FADV_SEQUENTIAL);
+  *file_size = st.st_size;
+  return H;
+}
+
+// maps a snapshot on tmpfs or hugetlbfs read-only. the pages stay on the
+// nodes the saving process bound them to, and are shared by all runs.
+static struct mempool_t attach_snapshot(int fd, U64_t file_size) {
+  struct mempool_t M;
+  memset(&M, 0x00, sizeof(struct mempool_t));
+  M.nodeid = -1;
+  if ( !is_shared_memory_file(fd) ) return M;
+  void *p = mmap(NULL, file_size, PROT_READ, MAP_SHARED | MAP_POPULATE, fd, 0);
+  if (p != MAP_FAILED) {
+    M.pool = (unsigned char *)p;
+    M.memsize = file_size;
+  }
+  return M;
+}
+
+// SNAPSHOT_VERIFY=1 checksums the sections of an attached snapshot in the
+// mapping, the edges (is_graph=0) or start/end (is_graph=1) of each node.
+// returns nonzero if any of them is corrupted.
+static int verify_attached_sections(const struct mempool_t *shared, int num_graphs,
+                                    struct snapshot_header_t *H, int is_graph) {
+  if ( !getenvi((char *)ENV_SNAPSHOT_VERIFY, 0) ) return 0;
+  int num_io = 0, corrupted = 0;
+  struct snapshot_io_t *IO = (struct snapshot_io_t *)CALLOCA(2 * num_graphs * sizeof(struct snapshot_io_t));
+  U64_t *sums = (U64_t *)CALLOCA(2 * num_graphs * sizeof(U64_t));
+  for (int k = 0; k < num_graphs; ++k) {
+    if (is_graph) {
+      IO[num_io++] = (struct snapshot_io_t){ k, NULL, &H->graph[k].start };
+      IO[num_io++] = (struct snapshot_io_t){ k, NULL, &H->graph[k].end   };
+    } else {
+      IO[num_io++] = (struct snapshot_io_t){ k, NULL, &H->graph[k].edges };
+    }
+  }
+  transfer_sections(-1, shared->pool, 0, num_io, IO, sums);
+  for (int i = 0; i < num_io; ++i) {
+    corrupted |= sums[i] != IO[i].S->checksum;
+  }
+  return corrupted;
+}
+
+void detach_snapshot(struct mempool_t *shared) {
+  if (shared->pool) {
+    assert( !munmap(shared->pool, shared->memsize) );
+    shared->pool = NULL;
+  }
+}
+
+struct edgelist_t *restore_edgelist_snapshot(const char *filename, int num_lists, I64_t nbfs) {
+  const double t1 = get_seconds();
+  int fd;
+  U64_t file_size;
+  struct snapshot_header_t *H = open_snapshot(filename, num_lists, nbfs, &fd, &file_size);
+  if (!H) return NULL;
+  if (!H->has_edgelist) {
+    printf("[snapshot] '%s' has no edgelist\n", filename);
+    close(fd);
+    free(H);
+    return NULL;
+  }
+
+  struct edgelist_t *list = NULL;
+  struct mempool_t shared = attach_snapshot(fd, file_size);
+  I64_t failed = 0;
+  int corrupted = 0;
+  if (shared.pool) {
+    /* zero copy: the edges are in the mapping, and the pools are empty */
+    assert( list = (struct edgelist_t *)calloc(1, sizeof(struct edgelist_t)) );
+    list->num_nodes = H->num_nodes;
+    list->num_edges = H->num_edges;
+    list->num_lists = num_lists;
+    list->numsrcs   = nbfs;
+    list->shared    = shared;
+    assert( list->IJ_list = (struct IJ_list_t *)calloc(num_lists+1, sizeof(struct IJ_list_t)) );
+    assert( list->pool    = (struct mempool_t *)calloc(num_lists+1, sizeof(struct mempool_t)) );
+    assert( list->srcs    = (I64_t *)calloc(nbfs, sizeof(I64_t)) );
+    for (int k = 0; k < num_lists; ++k) {
+      list->IJ_list[k].offset = H->graph[k].edges_offset;
+      list->IJ_list[k].length = H->graph[k].edges_length;
+      list->IJ_list[k].edges  = (struct packed_edge *)&shared.pool[H->graph[k].edges.pos];
+    }
+    list->IJ_list[num_lists].offset = list->num_edges;
+    memcpy(list->srcs, &shared.pool[H->srcs.pos], H->srcs.size);
+    corrupted |= verify_attached_sections(&shared, num_lists, H, 0);
+  } else {
+    assert( list = allocate_edgelist_numa(SCALE, edgefactor, num_lists, nbfs) );
+    assert( list->num_edges == H->num_edges );
+
+    int num_io = 0;
+    struct snapshot_io_t *IO = (struct snapshot_io_t *)CALLOCA(num_lists * sizeof(struct snapshot_io_t));
+    U64_t *sums = (U64_t *)CALLOCA(num_lists * sizeof(U64_t));
+    for (int k = 0; k < num_lists; ++k) {
+      struct IJ_list_t *IJ_list = &list->IJ_list[k];
+      assert( IJ_list->offset == H->graph[k].edges_offset && IJ_list->length == H->graph[k].edges_length );
+      IO[num_io++] = (struct snapshot_io_t){ k, (unsigned char *)IJ_list->edges, &H->graph[k].edges };
+    }
+    failed += transfer_sections(fd, NULL, 0, num_io, IO, sums);
+    failed += io_bytes(fd, 0, (unsigned char *)list->srcs, H->srcs.size, H->srcs.pos);
+    for (int i = 0; i < num_io; ++i) {
+      corrupted |= sums[i] != IO[i].S->checksum;
+    }
+  }
+  close(fd);
+
+  corrupted |= checksum_bytes((unsigned char *)list->srcs, 0, H->srcs.size) != H->srcs.checksum;
+  if (failed || corrupted) {
+    printf("[snapshot] edgelist of '%s' is %s\n", filename, failed ? "unreadable" : "corrupted");
+    free_edgelist(list);
+    free(H);
+    return NULL;
+  }
+
+  const double t2 = get_seconds();
+  list->time = t2 - t1;
+  printf("[snapshot] %s edgelist of '%s' (m=%lld, %.3f seconds)\n",
+         list->shared.pool ? "attached" : "restored", filename, list->num_edges, t2-t1);
+  free(H);
+  return list;
+}
+
+struct graph_t *restore_graph_snapshot(const char *filename, struct edgelist_t *list) {
+  const double t1 = get_seconds();
+  int fd;
+  U64_t file_size;
+  struct snapshot_header_t *H = open_snapshot(filename, list->num_lists, list->numsrcs, &fd, &file_size);
+  if (!H) return NULL;
+  if ( H->num_nodes != list->num_nodes || H->num_edges != list->num_edges ||
+       H->srcs.checksum != checksum_bytes((unsigned char *)list->srcs, 0, list->numsrcs * sizeof(I64_t)) ) {
+    printf("[snapshot] '%s' does not match the edgelist\n", filename);
+    close(fd);
+    free(H);
+    return NULL;
+  }
+
+  struct graph_t *G = NULL;
+  struct mempool_t shared = attach_snapshot(fd, file_size);
+  I64_t failed = 0;
+  int corrupted = 0;
+  if (shared.pool) {
+    /* zero copy: start/end are in the mapping, and the pools are empty */
+    assert( G = (struct graph_t *)calloc(1, sizeof(struct graph_t)) );
+    G->n          = H->num_nodes;
+    G->m          = H->m;
+    G->chunk      = H->chunk;
+    G->num_graphs = H->num_graphs;
+    G->shared     = shared;
+    assert( G->BG_list = (struct subgraph_t *)calloc(G->num_graphs+1, sizeof(struct subgraph_t)) );
+    assert( G->pool    = (struct mempool_t  *)calloc(G->num_graphs+1, sizeof(struct mempool_t )) );
+    for (int k = 0; k < G->num_graphs; ++k) {
+      struct subgraph_t *BG = &G->BG_list[k];
+      BG->n      = H->graph[k].n;
+      BG->m      = H->graph[k].m;
+      BG->offset = H->graph[k].offset;
+      BG->start  = (I64_t *)&shared.pool[H->graph[k].start.pos];
+      BG->end    = (I64_t *)&shared.pool[H->graph[k].end.pos];
+    }
+    corrupted |= verify_attached_sections(&shared, G->num_graphs, H, 1);
+  } else {
+    /* allocation in the same layout as construction */
+    I64_t *num_edges = (I64_t *)CALLOCA(H->num_graphs * sizeof(I64_t));
+    for (int k = 0; k < H->num_graphs; ++k) {
+      num_edges[k] = H->graph[k].m;
+    }
+    assert( G = allocate_graph_numa(H->num_nodes, H->num_graphs, num_edges) );
+    assert( G->chunk == H->chunk );
+
+    int num_io = 0;
+    struct snapshot_io_t *IO = (struct snapshot_io_t *)CALLOCA(2 * G->num_graphs * sizeof(struct snapshot_io_t));
+    U64_t *sums = (U64_t *)CALLOCA(2 * G->num_graphs * sizeof(U64_t));
+    for (int k = 0; k < G->num_graphs; ++k) {
+      struct subgraph_t *BG = &G->BG_list[k];
+      assert( BG->n == H->graph[k].n && BG->offset == H->graph[k].offset );
+      IO[num_io++] = (struct snapshot_io_t){ k, (unsigned char *)BG->start, &H->graph[k].start };
+      IO[num_io++] = (struct snapshot_io_t){ k, (unsigned char *)BG->end,   &H->graph[k].end   };
+    }
+    failed += transfer_sections(fd, NULL, 0, num_io, IO, sums);
+    for (int i = 0; i < num_io; ++i) {
+      corrupted |= sums[i] != IO[i].S->checksum;
+    }
+  }
+  close(fd);
+
+  if (failed || corrupted) {
+    printf("[snapshot] graph of '%s' is %s\n", filename, failed ? "unreadable" : "corrupted");
+    free_graph(G);
+    free(H);
+    return NULL;
+  }
+
+  const double t2 = get_seconds();
+  printf("[snapshot] %s graph of '%s' (n=%lld, m=%lld, %.3f seconds)\n",
+         G->shared.pool ? "attached" : "restored", filename, G->n, G->m, t2-t1);
+  free(H);
+  return G;
+}
@@ -0,0 +1,68 @@
+/* ------------------------------------------------------------------------ *
+ * This is part of NETALX.
+ *
+ * Copyright (C) 2013-2015 The GraphCREST Project, Tokyo Institute of Technology
+ *
+ * NETALX is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ * ------------------------------------------------------------------------ */
+
+
+#ifndef SNAPSHOT_H
+#define SNAPSHOT_H
+
+#include "ulibc.h"
+#include "defs.h"
+#include "generation.h"
+#include "construction.h"
+
+/* -----------------------------
+ * binary graph snapshot (in-core)
+ * ----------------------------- */
+// SNAPSHOT=FILE makes graph500 restore the edgelist, the BFS roots and the
+// CSR graph from FILE instead of generation and construction, or save them
+// to FILE after construction if it is missing or does not match the run
+// (SCALE, edgefactor, generator, seed and #NUMA nodes). sections are read
+// into the NUMA node local pools by the threads of each node with preads.
+// SNAPSHOT_EDGELIST=0 omits the edgelist; it is regenerated on restore.
+// a snapshot on tmpfs (/dev/shm) or hugetlbfs is a resident graph: it is
+// saved with hugepage aligned sections bound to the node of each sub-graph,
+// and later runs attach it read-only by mmap without copying or checksums.
+// SNAPSHOT_VERIFY=1 checksums the attached sections in the mapping as well.
+// graph500_exmem and graph500_restore take no snapshot: their on-DRAM part
+// (start arrays, on-DRAM end arrays) is rebuilt from the NVM files by
+// construction_restore.c and is not attached.
+#define ENV_SNAPSHOT                  "SNAPSHOT"
+#define ENV_SNAPSHOT_EDGELIST         "SNAPSHOT_EDGELIST"
+#define ENV_SNAPSHOT_VERIFY           "SNAPSHOT_VERIFY"
+
+#define SNAPSHOT_MAGIC                "NETALXGS"
+#define SNAPSHOT_VERSION              1
+#define SNAPSHOT_ALIGN                (1ULL << 12)
+#define SNAPSHOT_IO_LENGTH            (1ULL << 24)  /* bytes per pread/pwrite */
+
+// returns the edgelist and the BFS roots of a matching snapshot, or NULL.
+struct edgelist_t *restore_edgelist_snapshot(const char *filename, int num_lists, I64_t nbfs);
+
+// returns the graph of a snapshot that matches list, or NULL.
+struct graph_t *restore_graph_snapshot(const char *filename, struct edgelist_t *list);
+
+// writes G, the roots and (unless SNAPSHOT_EDGELIST=0) the edges of list to
+// filename. returns 0 on success.
+int save_snapshot(const char *filename, struct graph_t *G, struct edgelist_t *list);
+
+// unmaps an attached snapshot (the shared field of a graph or an edgelist).
+void detach_snapshot(struct mempool_t *shared);
+
+#endif /* SNAPSHOT_H */
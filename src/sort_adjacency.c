@@ -0,0 +1,471 @@
+/* ------------------------------------------------------------------------ *
+ * This is part of NETALX.
+ *
+ * Copyright (C) 2013-2015 The GraphCREST Project, Tokyo Institute of Technology
+ *
+ * NETALX is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ * ------------------------------------------------------------------------ */
+
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+
+#include "ulibc.h"
+#include "defs.h"
+#include "atomic.h"
+#include "construction.h"
+#include "sort_adjacency.h"
+
+
+/* ------------------------------------------------------------
+ * insertion sort and quicksort, specialized by a less-than macro
+ * ------------------------------------------------------------ */
+#define DEFINE_SORT(NAME, TYPE, LESS)                                   \
+  static void NAME##_insertion(TYPE *a, I64_t n, const void *ctx) {     \
+    (void)ctx;                                                          \
+    for (I64_t i = 1; i < n; ++i) {                                     \
+      const TYPE x = a[i];                                              \
+      I64_t j = i;                                                      \
+      for (; j > 0 && LESS(x, a[j-1]); --j) a[j] = a[j-1];              \
+      a[j] = x;                                                         \
+    }                                                                   \
+  }                                                                     \
+  static void NAME(TYPE *a, I64_t n, const void *ctx) {                 \
+    while (n >= SORT_INSERTION_THRESHOLD) {                             \
+      TYPE t, p = a[n/2];                                               \
+      if (LESS(a[n-1], a[0])) { t = a[0]; a[0] = a[n-1]; a[n-1] = t; }  \
+      if (LESS(p, a[0])) p = a[0];                                      \
+      else if (LESS(a[n-1], p)) p = a[n-1];                             \
+      I64_t i = 0, j = n-1;                                             \
+      for (;;) {                                                        \
+        while (LESS(a[i], p)) ++i;                                      \
+        while (LESS(p, a[j])) --j;                                      \
+        if (i >= j) break;                                              \
+        t = a[i]; a[i] = a[j]; a[j] = t;                                \
+        ++i; --j;                                                       \
+      }                                                                 \
+      /* recurse into the smaller part */                               \
+      if (j+1 < n-j-1) { NAME(a, j+1, ctx); a += j+1; n -= j+1; }       \
+      else             { NAME(&a[j+1], n-j-1, ctx); n = j+1; }          \
+    }                                                                   \
+    NAME##_insertion(a, n, ctx);                                        \
+  }
+
+#define KEY_LESS(x, y)  ( (x) < (y) )
+DEFINE_SORT(quicksort_keys, U64_t, KEY_LESS)
+
+/* fallback when (degree, vertex) does not fit a key: descending order */
+#define VERTEX_LESS(x, y)                                               \
+  ( ((const I64_t *)ctx)[x] != ((const I64_t *)ctx)[y]                  \
+    ? ((const I64_t *)ctx)[x] > ((const I64_t *)ctx)[y] : (x) > (y) )
+DEFINE_SORT(quicksort_vertices, I64_t, VERTEX_LESS)
+
+
+/* ------------------------------------------------------------
+ * sort_uniq_keys
+ * ------------------------------------------------------------ */
+/* LSD radix sort over the bits that differ among the keys */
+static void radix_sort_keys(U64_t *key, I64_t n, U64_t *work) {
+  const I64_t radix = 1LL << SORT_RADIX_BITS;
+  I64_t count[1LL << SORT_RADIX_BITS];
+  U64_t diff = 0;
+  I64_t i;
+  for (i = 1; i < n; ++i) {
+    diff |= key[i] ^ key[0];
+  }
+  if (diff == 0) return ;
+
+  const int lo = __builtin_ctzll(diff), hi = 64 - __builtin_clzll(diff);
+  U64_t *src = key, *dst = work, *t;
+  for (int shift = lo; shift < hi; shift += SORT_RADIX_BITS) {
+    memset(count, 0x00, sizeof(count));
+    for (i = 0; i < n; ++i) {
+      ++count[ (src[i] >> shift) & (radix-1) ];
+    }
+    I64_t sum = 0;
+    for (i = 0; i < radix; ++i) {
+      const I64_t c = count[i];
+      count[i] = sum;
+      sum += c;
+    }
+    for (i = 0; i < n; ++i) {
+      dst[ count[ (src[i] >> shift) & (radix-1) ]++ ] = src[i];
+    }
+    t = src; src = dst; dst = t;
+  }
+  if (src != key) {
+    memcpy(key, src, n * sizeof(U64_t));
+  }
+}
+
+static I64_t uniq_keys(U64_t *key, I64_t n) {
+  I64_t i, crr;
+  for (i = crr = 1; i < n; ++i) {
+    if (key[i] != key[crr-1]) key[crr++] = key[i];
+  }
+  return crr;
+}
+
+I64_t sort_uniq_keys(U64_t *key, I64_t n, U64_t *work) {
+  if (n < 2) return n;
+  if (n < SORT_RADIX_THRESHOLD) {
+    quicksort_keys(key, n, NULL);
+  } else {
+    radix_sort_keys(key, n, work);
+  }
+  return uniq_keys(key, n);
+}
+
+
+/* ------------------------------------------------------------
+ * sort_uniq_keys_parallel
+ *   sample sort by all threads of the team (called by each of them):
+ *   the keys are split by threads-1 sampled splitters, and each thread
+ *   sorts and dedups one bucket. equal keys fall into the same bucket.
+ * ------------------------------------------------------------ */
+struct hub_sort_t {
+  int threads;
+  U64_t *splitter;  /* [threads-1] */
+  I64_t *offset;    /* [threads][threads] : bucket-major write offsets */
+  I64_t *base;      /* [threads+1] */
+  I64_t *uniq;      /* [threads+1] */
+};
+
+static inline int find_bucket(const U64_t *splitter, int num_splitters, U64_t x) {
+  int l = 0, u = num_splitters;
+  while (l < u) {
+    const int m = (l + u) / 2;
+    if (splitter[m] <= x) l = m+1; else u = m;
+  }
+  return l;
+}
+
+static I64_t sort_uniq_keys_parallel(U64_t *key, I64_t n, U64_t *work, struct hub_sort_t *H, int id) {
+  const int T = H->threads;
+  I64_t *row = &H->offset[id * T];
+  I64_t i, ls, le;
+  int b;
+
+  if (id == 0) {
+    const I64_t S = (I64_t)T * SORT_SAMPLES_PER_THREAD;
+    for (i = 0; i < S; ++i) {
+      work[i] = key[ i * n / S ];
+    }
+    quicksort_keys(work, S, NULL);
+    for (b = 0; b < T-1; ++b) {
+      H->splitter[b] = work[ (I64_t)(b+1) * SORT_SAMPLES_PER_THREAD ];
+    }
+  }
+  OMP("omp barrier");
+
+  partial_range(n, 0, T, id, &ls, &le);
+  memset(row, 0x00, T * sizeof(I64_t));
+  for (i = ls; i < le; ++i) {
+    ++row[ find_bucket(H->splitter, T-1, key[i]) ];
+  }
+  OMP("omp barrier");
+
+  if (id == 0) {
+    I64_t sum = 0;
+    for (b = 0; b < T; ++b) {
+      H->base[b] = sum;
+      for (int p = 0; p < T; ++p) {
+        const I64_t c = H->offset[p * T + b];
+        H->offset[p * T + b] = sum;
+        sum += c;
+      }
+    }
+    H->base[T] = sum;
+  }
+  OMP("omp barrier");
+
+  for (i = ls; i < le; ++i) {
+    work[ row[ find_bucket(H->splitter, T-1, key[i]) ]++ ] = key[i];
+  }
+  OMP("omp barrier");
+
+  /* bucket id: sorted in work[], with key[] of the bucket as scratch */
+  const I64_t bs = H->base[id], bn = H->base[id+1] - bs;
+  H->uniq[id+1] = sort_uniq_keys(&work[bs], bn, &key[bs]);
+  OMP("omp barrier");
+
+  if (id == 0) {
+    H->uniq[0] = 0;
+    for (b = 0; b < T; ++b) {
+      H->uniq[b+1] += H->uniq[b];
+    }
+  }
+  OMP("omp barrier");
+
+  memcpy(&key[ H->uniq[id] ], &work[bs], (H->uniq[id+1] - H->uniq[id]) * sizeof(U64_t));
+  OMP("omp barrier");
+  return H->uniq[T];
+}
+
+
+/* ------------------------------------------------------------
+ * sort_adjacency_lists_by_degree
+ * ------------------------------------------------------------ */
+struct degree_key_t {
+  const I64_t *degree;
+  const unsigned char *degree_code;
+  int log_n;
+  int is_key;       /* (degree, vertex) fits a key */
+};
+
+/* a key ascends as (degree, vertex) descends */
+static inline U64_t vertex_to_key(const struct degree_key_t *K, I64_t v) {
+  const U64_t d = (K->degree) ? (U64_t)K->degree[v] : (U64_t)K->degree_code[v];
+  return ~( (d << K->log_n) | (U64_t)v );
+}
+
+static inline I64_t key_to_vertex(const struct degree_key_t *K, U64_t key) {
+  return (I64_t)( ~key & ((1ULL << K->log_n) - 1) );
+}
+
+static I64_t sort_list(const struct degree_key_t *K, I64_t *list, I64_t dg, U64_t *work) {
+  I64_t i, uniq_dg;
+  if (K->is_key) {
+    U64_t *key = (U64_t *)list;
+    for (i = 0; i < dg; ++i) key[i] = vertex_to_key(K, list[i]);
+    uniq_dg = sort_uniq_keys(key, dg, work);
+    for (i = 0; i < uniq_dg; ++i) list[i] = key_to_vertex(K, key[i]);
+  } else {
+    quicksort_vertices(list, dg, K->degree);
+    for (i = uniq_dg = 1; i < dg; ++i) {
+      if (list[i] != list[uniq_dg-1]) list[uniq_dg++] = list[i];
+    }
+  }
+  for (i = uniq_dg; i < dg; ++i) list[i] = -1; /* filled -1 */
+  return dg - uniq_dg;
+}
+
+I64_t sort_adjacency_lists_by_degree(struct subgraph_t *BG_list, int num_graphs, int is_node_local,
+                                     I64_t num_nodes, const I64_t *degree, const unsigned char *degree_code) {
+  const int threads = get_numa_num_threads();
+  struct degree_key_t K = { degree, degree_code, 0, 1 };
+  I64_t duplicates = 0, max_degree = 0;
+  int k;
+
+  while ((1LL << K.log_n) < num_nodes) ++K.log_n;
+  if (degree) {
+    OMP("omp parallel for num_threads(threads) reduction(max:max_degree)")
+    for (I64_t v = 0; v < num_nodes; ++v) {
+      if (max_degree < degree[v]) max_degree = degree[v];
+    }
+  } else {
+    max_degree = 255;
+  }
+  K.is_key = ( K.log_n + (64 - __builtin_clzll((U64_t)max_degree | 1)) <= 64 );
+
+  /* hub lists are left to the second step */
+  I64_t num_hubs = 0, max_hub = 0, max_hubs = 1;
+  for (k = 0; k < num_graphs; ++k) {
+    max_hubs += BG_list[k].m / SORT_PARALLEL_THRESHOLD;
+  }
+  struct { int k; I64_t j; } *hubs = NULL;
+  assert( hubs = calloc(max_hubs, sizeof(*hubs)) );
+
+  OMP("omp parallel num_threads(threads) reduction(+:duplicates)") {
+    int id = omp_get_thread_num();
+    int nodeid = get_numa_nodeid(id);
+    int coreid = get_numa_vircoreid(id);
+    int lcores = get_numa_online_cores(nodeid);
+    pinned(USE_HYBRID_AFFINITY, id);
+    I64_t work_size = SORT_PARALLEL_THRESHOLD;
+    U64_t *work = NULL;
+    assert( work = (U64_t *)malloc(work_size * sizeof(U64_t)) );
+
+    for (int kk = 0; kk < num_graphs; ++kk) {
+      if (is_node_local && kk != nodeid) continue;
+      struct subgraph_t *BG = &BG_list[kk];
+      const I64_t offset = BG->start[0];
+      I64_t j, ls, le;
+      if (is_node_local) partial_range(BG->n, 0, lcores,  coreid, &ls, &le);
+      else               partial_range(BG->n, 0, threads, id,     &ls, &le);
+      for (j = ls; j < le; ++j) {
+        const I64_t bs = BG->start[j], be = BG->start[j+1], dg = be-bs;
+        if (dg >= SORT_PARALLEL_THRESHOLD && threads > 1 && K.is_key) {
+          const I64_t h = SYNC_FETCH_AND_ADD(&num_hubs, 1);
+          hubs[h].k = kk;
+          hubs[h].j = j;
+          OMP("omp critical")
+          if (max_hub < dg) max_hub = dg;
+          continue;
+        }
+        if (dg > work_size) {
+          work_size = dg;
+          assert( work = (U64_t *)realloc(work, work_size * sizeof(U64_t)) );
+        }
+        if (dg) {
+          duplicates += sort_list(&K, &BG->end[bs - offset], dg, work);
+        }
+      }
+    }
+    free(work);
+    clear_affinity();
+  }
+
+  /* hub lists by all threads */
+  if (num_hubs > 0) {
+    struct hub_sort_t H;
+    U64_t *work = NULL;
+    H.threads = threads;
+    assert( work       = (U64_t *)malloc(max_hub * sizeof(U64_t)) );
+    assert( H.splitter = (U64_t *)calloc(threads, sizeof(U64_t)) );
+    assert( H.offset   = (I64_t *)calloc((I64_t)threads * threads, sizeof(I64_t)) );
+    assert( H.base     = (I64_t *)calloc(threads+1, sizeof(I64_t)) );
+    assert( H.uniq     = (I64_t *)calloc(threads+1, sizeof(I64_t)) );
+
+    OMP("omp parallel num_threads(threads) reduction(+:duplicates)") {
+      int id = omp_get_thread_num();
+      pinned(USE_HYBRID_AFFINITY, id);
+      for (I64_t h = 0; h < num_hubs; ++h) {
+        struct subgraph_t *BG = &BG_list[ hubs[h].k ];
+        const I64_t bs = BG->start[hubs[h].j], dg = BG->start[hubs[h].j+1] - bs;
+        I64_t *list = &BG->end[bs - BG->start[0]];
+        U64_t *key = (U64_t *)list;
+        I64_t i, ls, le, uniq_dg;
+
+        partial_range(dg, 0, threads, id, &ls, &le);
+        for (i = ls; i < le; ++i) key[i] = vertex_to_key(&K, list[i]);
+        OMP("omp barrier");
+        uniq_dg = sort_uniq_keys_parallel(key, dg, work, &H, id);
+        partial_range(uniq_dg, 0, threads, id, &ls, &le);
+        for (i = ls; i < le; ++i) list[i] = key_to_vertex(&K, key[i]);
+        partial_range(dg - uniq_dg, uniq_dg, threads, id, &ls, &le);
+        for (i = ls; i < le; ++i) list[i] = -1; /* filled -1 */
+        if (id == 0) duplicates += dg - uniq_dg;
+        OMP("omp barrier");
+      }
+      clear_affinity();
+    }
+    free(work);
+    free(H.splitter);
+    free(H.offset);
+    free(H.base);
+    free(H.uniq);
+  }
+  free(hubs);
+
+  return duplicates;
+}
+
+
+/* ------------------------------------------------------------
+ * compact_adjacency_lists
+ *   each thread compacts the lists of its vertex range to the front
+ *   of its range, then moves them to the offset given by the prefix
+ *   sum of the survivors. the moves go left by d (#duplicates before
+ *   the range); the last min(d, survivors) edges of a range can be
+ *   overwritten by the next ranges and are stashed before the moves.
+ * ------------------------------------------------------------ */
+I64_t compact_adjacency_lists(struct subgraph_t *BG_list, int num_graphs, int is_node_local, I64_t start_base) {
+  const int threads = get_numa_num_threads();
+  I64_t (*surv)[MAX_CPUS+1] = NULL;
+  I64_t total = 0;
+  assert( surv = calloc(MAX_NODES, sizeof(*surv)) );
+
+  OMP("omp parallel num_threads(threads)") {
+    int id = omp_get_thread_num();
+    int nodeid = get_numa_nodeid(id);
+    int coreid = get_numa_vircoreid(id);
+    int lcores = get_numa_online_cores(nodeid);
+    pinned(USE_HYBRID_AFFINITY, id);
+    const int tid = (is_node_local) ? coreid : id;
+    const int nt  = (is_node_local) ? lcores : threads;
+    const int row = (is_node_local) ? nodeid : 0;
+
+    for (int g = 0; g < ((is_node_local) ? 1 : num_graphs); ++g) {
+      const int k = (is_node_local) ? nodeid : g;
+      struct subgraph_t *BG = (k < num_graphs) ? &BG_list[k] : NULL;
+      I64_t j, w, ls = 0, le = 0, in_s = 0, in_e = 0, base0 = 0;
+      I64_t *stash = NULL;
+      if (BG) {
+        partial_range(BG->n, 0, nt, tid, &ls, &le);
+        base0 = BG->start[0];
+        in_s = BG->start[ls] - base0;
+        in_e = BG->start[le] - base0;
+      }
+      OMP("omp barrier");
+
+      /* count and compact to the front of the range */
+      if (BG) {
+        I64_t crr = in_s, s = in_s;
+        for (j = ls; j < le; ++j) {
+          const I64_t e = (j+1 < le) ? BG->start[j+1] - base0 : in_e;
+          BG->start[j] = crr - in_s;
+          for (w = s; w < e; ++w) {
+            const I64_t v = BG->end[w];
+            if (v != -1) BG->end[crr++] = v;
+          }
+          s = e;
+        }
+        surv[row][tid+1] = crr - in_s;
+      }
+      OMP("omp barrier");
+
+      if (BG && tid == 0) {
+        surv[row][0] = 0;
+        for (int p = 0; p < nt; ++p) {
+          surv[row][p+1] += surv[row][p];
+        }
+      }
+      OMP("omp barrier");
+
+      /* stash, then move */
+      I64_t out = 0, live = 0, n_st = 0;
+      if (BG) {
+        out  = surv[row][tid];
+        live = surv[row][tid+1] - out;
+        n_st = (in_s - out < live) ? in_s - out : live;
+        if (n_st > 0) {
+          assert( stash = (I64_t *)malloc(n_st * sizeof(I64_t)) );
+          memcpy(stash, &BG->end[in_s + live - n_st], n_st * sizeof(I64_t));
+        }
+      }
+      OMP("omp barrier");
+
+      if (BG) {
+        if (out != in_s) {
+          memmove(&BG->end[out], &BG->end[in_s], (live - n_st) * sizeof(I64_t));
+        }
+        if (n_st > 0) {
+          memcpy(&BG->end[out + live - n_st], stash, n_st * sizeof(I64_t));
+          free(stash);
+        }
+        for (j = ls; j < le; ++j) {
+          BG->start[j] += start_base + out;
+        }
+        if (tid == 0) {
+          const I64_t m = surv[row][nt];
+          BG->start[BG->n] = start_base + m;
+          BG->m = m;
+          SYNC_FETCH_AND_ADD(&total, m);
+        }
+      }
+      OMP("omp barrier");
+    }
+    clear_affinity();
+  }
+  free(surv);
+
+  return total;
+}
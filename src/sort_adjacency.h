@@ -0,0 +1,59 @@
+/* ------------------------------------------------------------------------ *
+ * This is part of NETALX.
+ *
+ * Copyright (C) 2013-2015 The GraphCREST Project, Tokyo Institute of Technology
+ *
+ * NETALX is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ * ------------------------------------------------------------------------ */
+
+#ifndef SORT_ADJACENCY_H
+#define SORT_ADJACENCY_H
+
+#include "ulibc.h"
+#include "defs.h"
+#include "construction.h"
+
+/* -----------------------------
+ * sort + dedup of adjacency lists
+ * ----------------------------- */
+// an adjacent vertex v is sorted by the composite key (degree of v, v) in
+// descending order, the same order as intdegreecmp, and duplicates are
+// removed. lists are sorted by an insertion sort, a quicksort or an LSD
+// radix sort over the varying key bits, and hub lists by all threads.
+#define SORT_INSERTION_THRESHOLD      (1LL << 5)
+#define SORT_RADIX_THRESHOLD          (1LL << 8)
+#define SORT_RADIX_BITS               8
+#define SORT_PARALLEL_THRESHOLD       (1LL << 16)   /* hub lists */
+#define SORT_SAMPLES_PER_THREAD       64
+
+// sorts key[0..n) ascending, removes duplicates and returns #unique keys.
+// work[] holds n keys.
+I64_t sort_uniq_keys(U64_t *key, I64_t n, U64_t *work);
+
+// sorts the adjacency lists of BG_list[0..num_graphs) by (degree, vertex)
+// in descending order and fills the removed duplicates of each list with
+// -1. the degree of v is degree[v], or degree_code[v] if degree is NULL.
+// end[] of a subgraph starts at edge start[0]. if is_node_local, subgraph
+// k is sorted by the threads of NUMA node k, otherwise by all threads.
+// returns #duplicates.
+I64_t sort_adjacency_lists_by_degree(struct subgraph_t *BG_list, int num_graphs, int is_node_local,
+                                     I64_t num_nodes, const I64_t *degree, const unsigned char *degree_code);
+
+// removes the -1 filled duplicates of the adjacency lists in place by the
+// threads as above (counting, prefix sum and scatter), and rewrites start[]
+// to start from start_base and m. returns the sum of m.
+I64_t compact_adjacency_lists(struct subgraph_t *BG_list, int num_graphs, int is_node_local, I64_t start_base);
+
+#endif /* SORT_ADJACENCY_H */
@@ -245,20 +245,31 @@ I64_t validate_bfs_tree(struct graph_t *G, struct bfs_t *BFS,
     OMP("omp barrier");
 
     struct IJ_list_t *IJ_list = &edgelist->IJ_list[nodeid];
-    struct packed_edge *IJ = IJ_list->edges;
-    I64_t ls, le;
+    struct packed_edge *IJ = IJ_list->edges, *E = NULL;
+    I64_t ls, le, cs = 0, ce = 0;
     partial_range(IJ_list->length, 0, lcores, coreid, &ls, &le);
 
+    /* a regenerated edgelist is streamed in chunks */
+    if (edgelist->regenerate) {
+      assert( E = (struct packed_edge *)malloc(REGENERATE_CHUNK_EDGES * sizeof(struct packed_edge)) );
+    }
+
     for (k = ls; k < le; ++k) {
-      const I64_t v = get_v0_from_edge(&IJ[k]);
-      const I64_t w = get_v1_from_edge(&IJ[k]);
+      if (E && k >= ce) {
+        cs = k;
+        ce = (le - cs < (I64_t)REGENERATE_CHUNK_EDGES) ? le : cs + (I64_t)REGENERATE_CHUNK_EDGES;
+        regenerate_edges(edgelist, IJ_list->offset + cs, IJ_list->offset + ce, E);
+      }
+      const struct packed_edge *e = E ? &E[k - cs] : &IJ[k];
+      const I64_t v = get_v0_from_edge(e);
+      const I64_t w = get_v1_from_edge(e);
       I64_t lvldiff;
 
       if (v < 0 || w < 0) continue;
       if (v > max_bfsvtx && w <= max_bfsvtx)
-        ++wrong_edges_v, printf("E[%d][%lld] is %p, (%lld,%lld)\n", nodeid, k, &IJ[k], v, w);
+        ++wrong_edges_v, printf("E[%d][%lld] is %p, (%lld,%lld)\n", nodeid, k, e, v, w);
       if (w > max_bfsvtx && v <= max_bfsvtx)
-        ++wrong_edges_w, printf("E[%d][%lld] is %p, (%lld,%lld)\n", nodeid, k, &IJ[k], v, w);
+        ++wrong_edges_w, printf("E[%d][%lld] is %p, (%lld,%lld)\n", nodeid, k, e, v, w);
 
       /* both v & w are on the same side of max_bfsvtx */
       if ( wrong_edges_v || wrong_edges_w || v > max_bfsvtx ) continue;
@@ -283,6 +294,7 @@ I64_t validate_bfs_tree(struct graph_t *G, struct bfs_t *BFS,
       /* Check that the levels differ by no more than one. */
       if (lvldiff > 1 || lvldiff < -1) ++not_adjacent;
     }
+    free(E);
 
     if ( wrong_edges_v) __sync_fetch_and_add(&sum_of_errors, wrong_edges_v);
     if ( wrong_edges_w) __sync_fetch_and_add(&sum_of_errors, wrong_edges_w);
@@ -156,6 +156,23 @@ static int compute_levels(int *hops, I64_t nv, I64_t root, struct bfs_t *BFS, I6
 
 
 
+/* the edge list kept on the far-memory node (FARMEM in the conf file)
+   by the first validation, or NULL */
+static struct dumpfiles_t *farmem_edgelist(void) {
+  static struct dumpfiles_t *DF = NULL;
+  static int is_loaded = 0;
+  if (!is_loaded) {
+    const int farmem_nodeid = get_farmem_nodeid();
+    if (farmem_nodeid >= 0) {
+      DF = init_dumpfile_info_edgelist("", 0);
+      open_files_readmode(DF);
+      load_files_farmem(DF, farmem_nodeid);
+    }
+    is_loaded = 1;
+  }
+  return DF;
+}
+
 I64_t validate_bfs_tree(struct graph_t *G, struct bfs_t *BFS,
                         struct edgelist_t *edgelist, I64_t root) {
   const I64_t max_bfsvtx = G->n-1;
@@ -191,17 +208,22 @@ I64_t validate_bfs_tree(struct graph_t *G, struct bfs_t *BFS,
 
   double level_time, tree1_time, tree2_time, t1, t2;
 
-  /* allocate and initialize file pointers */
-  struct dumpfiles_t *DF_E = init_dumpfile_info_edgelist("", 0);
+  /* allocate and initialize file pointers (none for a regenerated edgelist) */
+  const int is_regenerated = edgelist->regenerate;
+  struct dumpfiles_t *DF_E = is_regenerated ? NULL : farmem_edgelist();
+  const int is_farmem = (DF_E != NULL);
+  if (!is_farmem && !is_regenerated) {
+    DF_E = init_dumpfile_info_edgelist("", 0);
 #if DIRECT_IO_VALIDATION == 1
-  printf("[Direct I/O Validation] \t");
-  open_files_direct_readmode(DF_E);
+    printf("[Direct I/O Validation] \t");
+    open_files_direct_readmode(DF_E);
 #else
-  open_files_readmode(DF_E);
+    open_files_readmode(DF_E);
 #endif
+  }
 
   const size_t buf_lenght = (1ULL <<  20) / sizeof(struct packed_edge) * 4ULL; // 4 MBi
-  struct dump_buffer_t *BF = alloc_dump_buffer_with_size(DF_E->num_files, (1ULL << 20)*4ULL);
+  struct dump_buffer_t *BF = is_regenerated ? NULL : alloc_dump_buffer_with_size(DF_E->num_files, (1ULL << 20)*4ULL);
   // struct packed_edge **buf_list = (struct packed_edge **)calloc(buf_lenght, sizeof(struct packed_edge *));
   // for (int k=0; k<DF_E->num_files; k++) {
   //     assert( buf_list[k] = (struct packed_edge *)calloc(buf_lenght, sizeof(struct packed_edge)) );
@@ -273,24 +295,52 @@ I64_t validate_bfs_tree(struct graph_t *G, struct bfs_t *BFS,
     I64_t ls, le;
     partial_range(IJ_list->length, 0, lcores, coreid, &ls, &le);
 
-    int fd = DF_E->file_info_list[edgelist->num_lists*id + nodeid].fd;
+    const struct file_info_t *fi = NULL;
+    int fd = -1;
+    unsigned char *buf = NULL;
+    struct packed_edge *E = NULL;
+    if (is_regenerated) {
+      assert( E = (struct packed_edge *)malloc(REGENERATE_CHUNK_EDGES * sizeof(struct packed_edge)) );
+    } else {
+      fi = &DF_E->file_info_list[edgelist->num_lists*id + nodeid];
+      fd = fi->fd;
 #if (_XOPEN_SOURCE >= 600 || _POSIX_C_SOURCE >= 200112L) && !DIRECT_IO_VALIDATION
-    posix_fadvise(fd,
-                  sizeof(struct packed_edge)*ls,
-                  sizeof(struct packed_edge)*(le-ls),
-                  POSIX_FADV_SEQUENTIAL);
+      posix_fadvise(fd,
+                    sizeof(struct packed_edge)*ls,
+                    sizeof(struct packed_edge)*(le-ls),
+                    POSIX_FADV_SEQUENTIAL);
 #else
-    #warning posix_fadvise is not defined
+      #warning posix_fadvise is not defined
 #endif
-    unsigned char *buf = (unsigned char *)BF->buffer_pool[id].pool;
+      buf = (unsigned char *)BF->buffer_pool[id].pool;
+    }
     struct packed_edge *edges = NULL;
     I64_t edges_pos = (I64_t)buf_lenght+1;
 
 
     for (k = ls; k < le; ++k) {
 
+      // ---  regenerates from the seed --- //
+      if (E && edges_pos >= (I64_t)REGENERATE_CHUNK_EDGES) {
+        const I64_t n = (le - k < (I64_t)REGENERATE_CHUNK_EDGES) ? le - k : (I64_t)REGENERATE_CHUNK_EDGES;
+        regenerate_edges(edgelist, IJ_list->offset + k, IJ_list->offset + k + n, E);
+        edges = E;
+        edges_pos = 0;
+      }
+
+      // ---  loads from far memory --- //
+      if (fi && fi->farmem && edges_pos >= (I64_t)buf_lenght) {
+        edges = &((struct packed_edge *)fi->farmem)[k];
+        edges_pos = 0;
+#if NVM_EMULATION == 1
+        struct nvm_request_t R;
+        begin_nvm_request(fi, sizeof(struct packed_edge)*MIN(le - k, (I64_t)buf_lenght), &R);
+        end_nvm_request(&R);
+#endif
+      }
+
       // ---  buffered I/O --- //
-      if (edges_pos >= (I64_t)buf_lenght) {
+      if (!E && edges_pos >= (I64_t)buf_lenght) {
 
         size_t raw_offset_size = sizeof(struct packed_edge)*k;
         size_t len = (le - k < (I64_t)buf_lenght) ? le-k : (I64_t)buf_lenght;
@@ -305,8 +355,15 @@ I64_t validate_bfs_tree(struct graph_t *G, struct bfs_t *BFS,
           size_t read_size = raw_read_size;
         #endif
 
+#if NVM_EMULATION == 1
+        struct nvm_request_t R;
+        begin_nvm_request(fi, read_size, &R);
+#endif
         lseek(fd, offset_size, SEEK_SET);
         read(fd, buf, read_size);
+#if NVM_EMULATION == 1
+        end_nvm_request(&R);
+#endif
 
         #if DIRECT_IO_VALIDATION == 1
           edges = (struct packed_edge *)(buf + chip_size);
@@ -370,6 +427,7 @@ I64_t validate_bfs_tree(struct graph_t *G, struct bfs_t *BFS,
     if (  not_adjacent) __sync_fetch_and_add(&sum_of_errors, not_adjacent);
     if (   not_visited) __sync_fetch_and_add(&sum_of_wrong_nodes, not_visited);
     if ( multiple_root) __sync_fetch_and_add(&sum_of_wrong_nodes, multiple_root);
+    free(E);
 
 
     OMP("omp barrier");
@@ -434,10 +492,12 @@ done:
   }
 
   /* close files */
-  close_files(DF_E);
-  free_files(DF_E);
+  if (!is_farmem && !is_regenerated) {
+    close_files(DF_E);
+    free_files(DF_E);
+  }
 
-  free_dump_buffer(BF);
+  if (BF) free_dump_buffer(BF);
 
 
   if (err) {